@@ -6,6 +6,7 @@
 
 #include <Ethernet.h>
 #include <Metar.h>
+#include <MetarStream.h>
 #include <Convert.h>
 #include <Utils.h>
 
@@ -19,6 +20,7 @@ static const char *PASSWORD = USERNAME;
 // TODO - add ability to specify more units
 static const bool FAHRENHEIT = true;
 
+// FTP replies and the longest report line kept
 static const size_t BUF_SIZE = 192;
 
 void setup()
@@ -105,7 +107,7 @@ static void receiveFail(Client& client)
   client.stop();
 }
 
-static bool receive(Client& client, char *outBuf, bool data_flg = false)
+static bool receive(Client& client, char *outBuf)
 {
   while (!client.available()) delay(1);
 
@@ -119,8 +121,6 @@ static bool receive(Client& client, char *outBuf, bool data_flg = false)
 
   int idx = 0;
 
-  int lines = 0;
-
   delay(10);
   while (client.available())
   {
@@ -128,20 +128,7 @@ static bool receive(Client& client, char *outBuf, bool data_flg = false)
 
     if (idx < BUF_SIZE)
     {
-      if (data_flg)
-      {
-        if (c == '\n') lines++;
-      }
-
-      if (!data_flg)
-      {
-        outBuf[idx++] = c;
-      }
-      else if (lines)
-      {
-        if (c != '\n')
-          outBuf[idx++] = c;
-      }
+      outBuf[idx++] = c;
     }
   }
   outBuf[idx < BUF_SIZE ? idx : BUF_SIZE - 1] = '\0';
@@ -149,7 +136,44 @@ static bool receive(Client& client, char *outBuf, bool data_flg = false)
   return true;
 }
 
-static int getData(const char *station, char *buffer)
+static void displayMetar(Stream& stream, const char *metar_str,
+                         const MetarRecord& rec, bool fahr_flag);
+
+//
+// Decode the station file as it arrives.  Its first line is the
+// observation date and time, the second the report, which is displayed
+// from the one record the stream decodes into.
+//
+static void receiveReport(Client& client, Stream& stream, bool fahr_flag)
+{
+  char line[BUF_SIZE];
+  MetarStream metar_stream(line, sizeof(line));
+  MetarRecord rec;
+
+  auto display = [&](const char *metar_str, size_t, const MetarRecord& rec,
+                     bool)
+  {
+    if (rec.hasICAO())
+    {
+      displayMetar(stream, metar_str, rec, fahr_flag);
+    }
+  };
+
+  char chunk[32];
+  while (client.connected() || client.available())
+  {
+    int n = client.read(reinterpret_cast<uint8_t *>(chunk), sizeof(chunk));
+    if (n > 0)
+    {
+      metar_stream.Push(chunk, n, rec, display);
+    }
+  }
+
+  metar_stream.Finish(rec, display);
+}
+
+static int getData(const char *station, char *buffer, Stream& stream,
+                   bool fahr_flag)
 {
   EthernetClient client;
   const char *address = "tgftp.nws.noaa.gov";
@@ -197,14 +221,8 @@ static int getData(const char *station, char *buffer)
       client.print(station);
       client.println(".TXT");
       if (!receive(client, buffer)) return 0;
-      if (receive(dclient, buffer, true))
-      {
-        dclient.stop();
-      }
-      else
-      {
-        status = 0;
-      }
+      receiveReport(dclient, stream, fahr_flag);
+      dclient.stop();
       client.println("QUIT");
       client.stop();
     }
@@ -216,167 +234,168 @@ static int getData(const char *station, char *buffer)
 static void displayPage(Stream& stream, const char *station, bool fahr_flag)
 {
   char buffer[BUF_SIZE];
-  int status = getData(station, buffer);
-  if (status > 0)
+  int status = getData(station, buffer, stream, fahr_flag);
+  if (status <= 0)
   {
-    stream.println();
-    stream.println(buffer);
-    stream.println();
+    stream.print(status);
+    stream.print(": connection failed");
+  }
+}
 
-    auto metar = Metar::Create(buffer);
+static void displayMetar(Stream& stream, const char *metar_str,
+                         const MetarRecord& rec, bool fahr_flag)
+{
+  char buffer[16];
 
-    sprintf(buffer, "%02d:%02dZ", metar->Hour(), metar->Minute());
+  stream.println();
+  stream.println(metar_str);
+  stream.println();
 
-    stream.println(metar->ICAO());
-    stream.print("Observation time: ");
-    stream.println(buffer);
-    stream.println();
+  sprintf(buffer, "%02d:%02dZ", rec.hour, rec.minute);
 
-    double temp = metar->hasTemperatureNA() ? metar->TemperatureNA() : static_cast<double>(metar->Temperature());
-    stream.print("Temperature: ");
-    printTemp(stream, temp, fahr_flag, buffer);
+  stream.println(rec.icao);
+  stream.print("Observation time: ");
+  stream.println(buffer);
+  stream.println();
 
-    double feels_like(temp);
-    if (metar->hasWindSpeed())
-    {
-      double wind_kph;
-      switch (metar->WindSpeedUnits())
-      {
-        case Metar::speed_units::KT:
-          wind_kph = Convert::Kts2Kph(metar->WindSpeed());
-          break;
+  double temp = rec.hasTemperatureNA() ? rec.TemperatureNA() : static_cast<double>(rec.temp);
+  stream.print("Temperature: ");
+  printTemp(stream, temp, fahr_flag, buffer);
 
-        case Metar::speed_units::MPS:
-          wind_kph = metar->WindSpeed() / 1000.0;
-          break;
+  double feels_like(temp);
+  if (rec.hasWindSpeed())
+  {
+    double wind_kph;
+    switch (rec.wind_speed_units)
+    {
+      case Metar::speed_units::KT:
+        wind_kph = Convert::Kts2Kph(rec.wind_spd);
+        break;
 
-        default:
-          wind_kph = metar->WindSpeed();
-          break;
-      }
+      case Metar::speed_units::MPS:
+        wind_kph = rec.wind_spd / 1000.0;
+        break;
 
-      feels_like = Utils::WindChill(temp, wind_kph);
+      default:
+        wind_kph = rec.wind_spd;
+        break;
     }
 
-    double humidity;
-    double dew;
-    if (metar->hasDewPointNA() || metar->DewPointNA())
-    {
-      dew = metar->hasDewPointNA() ? metar->DewPointNA() : static_cast<double>(metar->DewPoint());
+    feels_like = Utils::WindChill(temp, wind_kph);
+  }
 
-      humidity =  Utils::Humidity(temp, dew);
-   
+  double humidity;
+  double dew;
+  if (rec.hasDewPointNA() || rec.DewPointNA())
+  {
+    dew = rec.hasDewPointNA() ? rec.DewPointNA() : static_cast<double>(rec.dew);
 
-      if (feels_like == temp)
-      {
-        feels_like = Utils::HeatIndex(temp, humidity, true);
-      }
-    
-    }
+    humidity =  Utils::Humidity(temp, dew);
+ 
 
-    if (feels_like != temp)
+    if (feels_like == temp)
     {
-      stream.print("Feels Like:  ");
-      printTemp(stream, feels_like, fahr_flag, buffer);
+      feels_like = Utils::HeatIndex(temp, humidity, true);
     }
-
-    if (metar->hasDewPointNA() || metar->DewPointNA())
-    {  
   
-      stream.print("Dew Point:   ");
-      printTemp(stream, dew, fahr_flag, buffer);
-  
-      dtostrf(humidity, 4, 1, buffer);
-  
-      sprintf(buffer, "%s%%", buffer);
-  
-      stream.print("Humidity:    ");
-      stream.println(buffer);
-    }
+  }
 
-    stream.println();
+  if (feels_like != temp)
+  {
+    stream.print("Feels Like:  ");
+    printTemp(stream, feels_like, fahr_flag, buffer);
+  }
+
+  if (rec.hasDewPointNA() || rec.DewPointNA())
+  {  
+
+    stream.print("Dew Point:   ");
+    printTemp(stream, dew, fahr_flag, buffer);
 
-    stream.print("Pressure:    ");
+    dtostrf(humidity, 4, 1, buffer);
 
-    if (metar->hasAltimeterA())
+    sprintf(buffer, "%s%%", buffer);
+
+    stream.print("Humidity:    ");
+    stream.println(buffer);
+  }
+
+  stream.println();
+
+  stream.print("Pressure:    ");
+
+  if (rec.hasAltimeterA())
+  {
+    stream.print(rec.AltimeterA());
+    stream.println(" inHg");
+  }
+  else if (rec.hasAltimeterQ())
+  {
+    stream.print(rec.altimeterQ);
+    stream.println(" hPa");
+  }
+  stream.println();
+
+  if (rec.hasWindSpeed())
+  {
+    stream.print("Wind:        ");
+    if (!rec.vrb)
     {
-      stream.print(metar->AltimeterA());
-      stream.println(" inHg");
+      stream.print(rec.wind_dir);
+      printDeg(stream);
+      stream.print(" / ");
     }
-    else if (metar->hasAltimeterQ())
+    else
     {
-      stream.print(metar->AltimeterQ());
-      stream.println(" hPa");
+      stream.print("VRB / ");
     }
+    stream.print(rec.wind_spd);
+    if (rec.hasWindGust())
+    {
+      stream.print(" (");
+      stream.print(rec.gust);
+      stream.print(")");
+    }
+    stream.print(" ");
+    stream.println(speed_units[static_cast<int>(rec.wind_speed_units)]);
     stream.println();
+  }
 
-    if (metar->hasWindSpeed())
+  if (rec.hasVisibility())
+  {
+    stream.print("Visibility:  ");
+    stream.print(rec.Visibility());
+    if (rec.vis_units == Metar::distance_units::M)
     {
-      stream.print("Wind:        ");
-      if (!metar->isVariableWindDirection())
-      {
-        stream.print(metar->WindDirection());
-        printDeg(stream);
-        stream.print(" / ");
-      }
-      else
-      {
-        stream.print("VRB / ");
-      }
-      stream.print(metar->WindSpeed());
-      if (metar->hasWindGust())
-      {
-        stream.print(" (");
-        stream.print(metar->WindGust());
-        stream.print(")");
-      }
-      stream.print(" ");
-      stream.println(speed_units[static_cast<int>(metar->WindSpeedUnits())]);
-      stream.println();
+      stream.println(" meters");
     }
-
-    if (metar->hasVisibility())
+    else
     {
-      stream.print("Visibility:  ");
-      stream.print(metar->Visibility());
-      if (metar->VisibilityUnits() == Metar::distance_units::M)
-      {
-        stream.println(" meters");
-      }
-      else
-      {
-        stream.println(" miles");
-      }
-      stream.println();
+      stream.println(" miles");
     }
+    stream.println();
+  }
 #ifndef NO_CLOUDS
-    for (unsigned int i = 0 ; i < metar->NumCloudLayers() ; i++)
+  for (unsigned int i = 0 ; i < rec.num_layers ; i++)
+  {
+    const CloudLayer& layer = rec.layers[i];
+    if (!layer.Temporary())
     {
-      auto layer = metar->Layer(i);
-      if (!layer->Temporary())
+      stream.print(sky_conditions[static_cast<int>(layer.Cover())]);
+      if (layer.hasAltitude())
       {
-        stream.print(sky_conditions[static_cast<int>(layer->Cover())]);
-        if (layer->hasAltitude())
+        stream.print(": ");
+        stream.print(layer.Altitude() * 100);
+        stream.print(" feet");
+        if (layer.hasCloudType())
         {
-          stream.print(": ");
-          stream.print(layer->Altitude() * 100);
-          stream.print(" feet");
-          if (layer->hasCloudType())
-          {
-            stream.print(" (");
-            stream.print(cloud_types[static_cast<int>(layer->CloudType())]);
-            stream.print(")");
-          }
+          stream.print(" (");
+          stream.print(cloud_types[static_cast<int>(layer.CloudType())]);
+          stream.print(")");
         }
-        stream.println();
       }
+      stream.println();
     }
-#endif
-    delete metar;
-  }
-  else
-  {
-    stream.print(status);
-    stream.print(": connection failed");
   }
+#endif
 }
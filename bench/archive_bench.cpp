@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// getline + Metar::Create vs a memory mapped Archive
+//
+
+#include "Archive.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static void report(const char *name, size_t n, size_t bytes, double seconds)
+{
+  cout << setw(12) << name
+       << setw(12) << fixed << setprecision(0) << n / seconds
+       << setw(10) << setprecision(1) << bytes / seconds / 1e6 << endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+
+  char path[] = "/tmp/archive_benchXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) return 1;
+  close(fd);
+
+  size_t bytes = 0;
+  {
+    ofstream file(path);
+    for (size_t i = 0 ; i < n ; i++)
+    {
+      string line = Bench::REPORTS[i % Bench::NUM_REPORTS];
+      file << line << '\n';
+      bytes += line.size() + 1;
+    }
+  }
+
+  unsigned int sink = 0;
+
+  cout << "      method   reports/s      MB/s" << endl;
+
+  {
+    Bench::Timer timer;
+    ifstream file(path);
+    string line;
+    while (getline(file, line))
+    {
+      auto metar = Metar::Create(line.c_str());
+      sink += metar->NumCloudLayers();
+    }
+    report("getline", n, bytes, timer.Seconds());
+  }
+
+  {
+    Bench::Timer timer;
+    auto archive = Archive::Open(path);
+    archive->Decode([&sink](const MetarRecord& rec, bool)
+    {
+      sink += rec.num_layers;
+    });
+    report("Archive", n, bytes, timer.Seconds());
+  }
+
+  unlink(path);
+
+  return sink ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Batch decode vs one Metar::Create per report
+//
+
+#include "Metar.h"
+#include "MetarRecord.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <cstdlib>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static void report(const char *name, size_t n, double seconds)
+{
+  cout << setw(12) << name
+       << setw(12) << fixed << setprecision(0) << n / seconds << endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000;
+  size_t passes = 20;
+
+  vector<MetarText> in;
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    const char *str = Bench::REPORTS[i % Bench::NUM_REPORTS];
+    in.push_back(MetarText{str, strlen(str)});
+  }
+
+  vector<MetarRecord> out(n);
+  unique_ptr<bool[]> ok(new bool[n]);
+  unsigned int sink = 0;
+
+  cout << "      method   reports/s" << endl;
+
+  {
+    Bench::Timer timer;
+    for (size_t p = 0 ; p < passes ; p++)
+    {
+      for (const auto& text : in)
+      {
+        auto metar = Metar::Create(text.str, text.len);
+        sink += metar->NumCloudLayers();
+      }
+    }
+    report("Create", n * passes, timer.Seconds());
+  }
+
+  {
+    Bench::Timer timer;
+    for (size_t p = 0 ; p < passes ; p++)
+    {
+      for (size_t i = 0 ; i < n ; i++)
+      {
+        Metar::Decode(in[i].str, in[i].len, out[i]);
+      }
+    }
+    report("Decode", n * passes, timer.Seconds());
+  }
+
+  {
+    Bench::Timer timer;
+    for (size_t p = 0 ; p < passes ; p++)
+    {
+      sink += Metar::DecodeBatch(in.data(), n, out.data(), ok.get());
+    }
+    report("DecodeBatch", n * passes, timer.Seconds());
+  }
+
+  return sink ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Benchmark helpers
+//
+
+#ifndef STORAGE_B_WEATHER_BENCH_H_
+#define STORAGE_B_WEATHER_BENCH_H_
+
+#include <chrono>
+#include <cstddef>
+
+namespace Bench
+{
+  //
+  // A representative mix of reports: US and international, with and
+  // without remarks, phenomena and multiple cloud layers
+  //
+  const char *const REPORTS[] =
+  {
+    "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029 RMK AO2 SLP260 T00940061 10100 20078 53002",
+    "METAR LBBG 041600Z 12012MPS 090V150 1400 R04/P1500N R22/P1500U +SN BKN022 OVC050 M04/M07 Q1020 NOSIG 8849//91=",
+    "SPECI KSTL 221513Z 07005KT 2SM -RA BR OVC005 02/02 A3041 RMK AO2 P0001 T00220022",
+    "KSTL 262051Z VRB04KT 10SM CLR 16/M01 A3023 RMK AO2 SLP242 T01561006 57015",
+    "KHLN 041610Z 28009KT 1/2SM SN FZFG VV007 M10/M12 A2998 RMK AO2 P0001 T11001117",
+    "KSTL 051520Z 12017KT 5SM -TSRA BR OVC007CB 06/05 A2989 RMK AO2 LTG DSNT SE OCNL LTGIC SE TSB0854 TS SE MOV NE P0004 T00560050",
+    "KSTL 091651Z 10010KT 060V120 10SM FEW120 BKN250 07/M06 A2998 RMK AO2 SLP160 T00671056",
+    "KSTL 192051Z 20004KT 10SM -RA FEW034 SCT048 OVC110 22/18 A2993 RMK AO2 PK WND 27032/2004 LTG DSNT E AND SE RAB06 TSB03E42 PRESFR SLP129 OCNL LTGIC DSNT E CB DSNT E MOV E P0003 60003 T02220178 58006 $",
+    "KSTL 261605Z 10006KT 7SM -TSRA FEW050CB OVC090 06/01 A3014 RMK AO2 LTG DSNT S AND SW TSB05 OCNL LTGIC SW-W TS SW-W MOV NE P0001 T00610006",
+    "EDDH 161150Z 24015G27KT 9999 VCBLSN FEW012 SCT025 BKN040 TEMPO SHSN 01/M02 Q1003",
+  };
+
+  const size_t NUM_REPORTS = sizeof(REPORTS) / sizeof(REPORTS[0]);
+
+  class Timer
+  {
+  public:
+    Timer() : _start(std::chrono::steady_clock::now()) {}
+
+    double Seconds() const
+    {
+      return std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - _start).count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point _start;
+  };
+}
+
+#endif
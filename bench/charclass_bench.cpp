@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Vector vs scalar character classification
+//
+
+#include "CharClass.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+typedef CharClass::Masks (*classifier)(const char *, size_t);
+
+static uint64_t classify(classifier f, const string& text, size_t passes)
+{
+  uint64_t sink = 0;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < text.size() ; i += CharClass::BLOCK_SIZE)
+    {
+      CharClass::Masks m = f(text.data() + i, text.size() - i);
+      sink += m.space ^ m.digit ^ m.alpha;
+    }
+  }
+
+  return sink;
+}
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000;
+
+  string text;
+  for (size_t i = 0 ; i < 100 ; i++)
+  {
+    text += Bench::REPORTS[i % Bench::NUM_REPORTS];
+    text += ' ';
+  }
+
+  uint64_t sink = 0;
+  double bytes = static_cast<double>(text.size()) * passes;
+
+  cout << "      method      MB/s" << endl;
+
+  {
+    Bench::Timer timer;
+    sink += classify(CharClass::ClassifyScalar, text, passes);
+    cout << setw(10) << "scalar"
+         << setw(10) << fixed << setprecision(1)
+         << bytes / timer.Seconds() / 1e6 << endl;
+  }
+
+  {
+    Bench::Timer timer;
+    sink += classify(CharClass::Classify, text, passes);
+    cout << setw(10) << "vector"
+         << setw(10) << fixed << setprecision(1)
+         << bytes / timer.Seconds() / 1e6 << endl;
+  }
+
+  return sink ? 0 : 1;
+}
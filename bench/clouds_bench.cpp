@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Cloud layer matching on the parser's fallthrough path
+//
+
+#include "Clouds.h"
+#include "Metar.h"
+#include "MetarRecord.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+//
+// Phenomenon heavy reports: most of the fallthrough tokens are weather
+// groups that are tried as cloud layers first and rejected
+//
+static const char *REPORTS[] =
+{
+  "METAR EDDH 071250Z 24018G32KT 2500 -SHRASN +TSRA VCSH BLSN FZFG BR BKN008CB OVC015 02/01 Q0998 TEMPO 0800 +SHSN SQ",
+  "SPECI KORD 121652Z 31022G35KT 1/2SM +TSRAGR FG VCTS FC BKN005 OVC010CB 18/17 A2968 RMK AO2 PK WND 30045/1638",
+  "METAR LFPG 150930Z 19005KT 0600 R27L/0800N FZDZ FZFG BR MIFG BCFG PRFG VV002 M01/M01 Q1031 BECMG 1500 BR",
+  "METAR OEJN 221200Z 34025KT 1500 SA DU BLSA DRSA VCSS HZ FU SCT040 36/08 Q1006 NOSIG"
+};
+static const size_t NUM_PHENOM_REPORTS = sizeof(REPORTS) / sizeof(REPORTS[0]);
+
+static vector<string> tokens()
+{
+  vector<string> out;
+  for (auto report : REPORTS)
+  {
+    const char *p = report;
+    while (*p)
+    {
+      const char *q = p;
+      while (*q && (*q != ' ')) q++;
+      out.emplace_back(p, q - p);
+      p = *q ? q + 1 : q;
+    }
+  }
+
+  return out;
+}
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+
+  vector<string> groups = tokens();
+
+  CloudLayer layer;
+  size_t sink = 0;
+
+  Bench::Timer timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (const auto& g : groups)
+    {
+      sink += Clouds::Decode(g.data(), g.size(), false, layer);
+    }
+  }
+  double seconds = timer.Seconds();
+
+  cout << "     tokens/s   layers/token" << endl;
+  cout << setw(13) << fixed << setprecision(0)
+       << groups.size() * passes / seconds
+       << setw(15) << setprecision(3)
+       << static_cast<double>(sink) / (groups.size() * passes) << endl;
+
+  MetarRecord rec;
+  size_t reports = passes / 10;
+
+  Bench::Timer decode_timer;
+  for (size_t p = 0 ; p < reports ; p++)
+  {
+    for (auto report : REPORTS)
+    {
+      sink += Metar::Decode(report, strlen(report), rec);
+    }
+  }
+  seconds = decode_timer.Seconds();
+
+  cout << "    reports/s" << endl;
+  cout << setw(13) << setprecision(0)
+       << NUM_PHENOM_REPORTS * reports / seconds << endl;
+
+  return sink ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Decoding each numeric group type on its own
+//
+
+#include "Metar.h"
+#include "MetarRecord.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+//
+// One group per line, the rest of the report left out so the digit
+// decoding is a large share of the time
+//
+static const struct
+{
+  const char *name;
+  const char *group;
+} GROUPS[] =
+{
+  { "time", "251656Z" },
+  { "wind", "270115G125KT" },
+  { "wind var", "240V300" },
+  { "vis m", "1400" },
+  { "vis sm", "1 11/16SM" },
+  { "vert vis", "VV007" },
+  { "temp", "M04/M07" },
+  { "alt", "A2992" },
+  { "slp", "SLP132" },
+  { "temp na", "T10521123" }
+};
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000000;
+
+  MetarRecord rec;
+  size_t sink = 0;
+
+  cout << "                groups/s" << endl;
+
+  for (const auto& g : GROUPS)
+  {
+    size_t len = strlen(g.group);
+
+    Bench::Timer timer;
+    for (size_t p = 0 ; p < passes ; p++)
+    {
+      sink += Metar::Decode(g.group, len, rec);
+    }
+    double seconds = timer.Seconds();
+
+    cout << setw(12) << g.name
+         << setw(14) << fixed << setprecision(0) << passes / seconds << endl;
+  }
+
+  return sink ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// A consumer that only wants wind and altimeter: Metar::Create vs
+// Metar::Decode vs EventDecoder
+//
+
+#include "EventDecoder.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+struct WindAltimeter : public MetarHandler
+{
+  long sum = 0;
+
+  void on_wind(int, int speed, int, Metar::speed_units, bool)
+  {
+    sum += speed;
+  }
+
+  void on_altimeter_a(int altimeter) { sum += altimeter; }
+  void on_altimeter_q(int altimeter) { sum += altimeter; }
+};
+
+static void report(const char *name, size_t n, double seconds)
+{
+  cout << setw(12) << name
+       << setw(14) << fixed << setprecision(0) << n / seconds << endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+
+  size_t lengths[Bench::NUM_REPORTS];
+  for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+  {
+    lengths[i] = strlen(Bench::REPORTS[i]);
+  }
+
+  const size_t n = passes * Bench::NUM_REPORTS;
+  long sink = 0;
+
+  cout << "               reports/s" << endl;
+
+  Bench::Timer create_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+    {
+      auto metar = Metar::Create(Bench::REPORTS[i], lengths[i]);
+      sink += metar->WindSpeed();
+      sink += metar->hasAltimeterQ() ? metar->AltimeterQ()
+                                     : metar->AltimeterA() * 100;
+    }
+  }
+  report("Create", n, create_timer.Seconds());
+
+  MetarRecord rec;
+  Bench::Timer decode_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+    {
+      Metar::Decode(Bench::REPORTS[i], lengths[i], rec);
+      sink += rec.wind_spd;
+      sink += rec.hasAltimeterQ() ? rec.altimeterQ : rec.altimeterA;
+    }
+  }
+  report("Decode", n, decode_timer.Seconds());
+
+  WindAltimeter handler;
+  Bench::Timer event_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+    {
+      EventDecoder::Decode(Bench::REPORTS[i], lengths[i], handler);
+    }
+  }
+  report("events", n, event_timer.Seconds());
+
+  return (sink + handler.sum) ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Sequential vs grammar driven group matching
+//
+
+#include "Metar.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static size_t count_tokens(const char *str)
+{
+  size_t n = 0;
+  bool in_token = false;
+  for ( ; *str ; str++)
+  {
+    if ((*str != ' ') && !in_token) n++;
+    in_token = (*str != ' ');
+  }
+  return n;
+}
+
+static void run(const char *name, Metar::parse_mode mode, size_t iterations)
+{
+  unsigned long long calls = 0;
+  unsigned long long tokens = 0;
+
+  for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+  {
+    unsigned int n;
+    const char *report = Bench::REPORTS[i];
+    Metar::Create(report, strlen(report), mode, &n);
+    calls += n;
+    tokens += count_tokens(report);
+  }
+
+  Bench::Timer timer;
+  unsigned int sink = 0;
+  for (size_t i = 0 ; i < iterations ; i++)
+  {
+    const char *report = Bench::REPORTS[i % Bench::NUM_REPORTS];
+    auto metar = Metar::Create(report, strlen(report), mode);
+    sink += metar->NumCloudLayers();
+  }
+  double rate = iterations / timer.Seconds();
+
+  cout << setw(12) << name
+       << setw(12) << fixed << setprecision(0) << rate
+       << setw(14) << setprecision(2) << static_cast<double>(calls) / tokens
+       << (sink ? "" : " ") << endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+
+  cout << "      mode   reports/s   calls/token" << endl;
+  run("SEQUENTIAL", Metar::parse_mode::SEQUENTIAL, iterations);
+  run("GRAMMAR", Metar::parse_mode::GRAMMAR, iterations);
+
+  return 0;
+}
@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Station status page: every report is created and its headline fields
+// read, the details of one in ten are opened.  Metar::Create vs
+// Metar::CreateLazy, then both again with every field of every report
+// read, where the lazy report should cost about one eager decode.
+//
+
+#include "Metar.h"
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static long read(const shared_ptr<Metar>& metar, bool details)
+{
+  long sum = metar->WindSpeed() + metar->Temperature();
+  if (details)
+  {
+    sum += metar->NumCloudLayers() + metar->NumPhenomena();
+    if (metar->hasSeaLevelPressure()) sum += metar->SeaLevelPressure();
+  }
+
+  return sum;
+}
+
+static long read_all(const shared_ptr<Metar>& metar)
+{
+  long sum = read(metar, true) + metar->Day() + metar->WindDirection()
+           + metar->Visibility() + metar->VerticalVisibility()
+           + metar->AltimeterA() + metar->TemperatureNA();
+  for (unsigned int i = 0 ; i < metar->NumCloudLayers() ; i++)
+  {
+    sum += metar->CloudLayers()[i].Altitude();
+  }
+  for (unsigned int i = 0 ; i < metar->NumPhenomena() ; i++)
+  {
+    sum += metar->Phenomenon(i).NumPhenom();
+  }
+
+  return sum;
+}
+
+static void report(const char *name, size_t n, double seconds)
+{
+  cout << setw(12) << name
+       << setw(14) << fixed << setprecision(0) << n / seconds << endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+
+  size_t lengths[Bench::NUM_REPORTS];
+  for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+  {
+    lengths[i] = strlen(Bench::REPORTS[i]);
+  }
+
+  const size_t n = passes * Bench::NUM_REPORTS;
+  long sink = 0;
+
+  cout << "               reports/s" << endl;
+
+  Bench::Timer create_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+    {
+      sink += read(Metar::Create(Bench::REPORTS[i], lengths[i]), i == p % 10);
+    }
+  }
+  report("Create", n, create_timer.Seconds());
+
+  Bench::Timer lazy_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+    {
+      sink += read(Metar::CreateLazy(Bench::REPORTS[i], lengths[i]),
+                   i == p % 10);
+    }
+  }
+  report("CreateLazy", n, lazy_timer.Seconds());
+
+  Bench::Timer create_all_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+    {
+      sink += read_all(Metar::Create(Bench::REPORTS[i], lengths[i]));
+    }
+  }
+  report("Create all", n, create_all_timer.Seconds());
+
+  Bench::Timer lazy_all_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+    {
+      sink += read_all(Metar::CreateLazy(Bench::REPORTS[i], lengths[i]));
+    }
+  }
+  report("Lazy all", n, lazy_all_timer.Seconds());
+
+  return sink ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// ParallelDecoder scaling over a line-delimited archive
+//
+
+#include "ParallelDecoder.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdlib>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+int main(int argc, char **argv)
+{
+  size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+  unsigned int max_threads = max(thread::hardware_concurrency(), 1U);
+
+  string archive;
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    archive += Bench::REPORTS[i % Bench::NUM_REPORTS];
+    archive += '\n';
+  }
+
+  vector<MetarRecord> out;
+  double base = 0.0;
+  size_t sink = 0;
+
+  cout << " threads   reports/s  speedup" << endl;
+
+  for (unsigned int threads = 1 ; threads <= max_threads ; threads *= 2)
+  {
+    auto decoder = ParallelDecoder::Create(threads);
+
+    Bench::Timer timer;
+    sink += decoder->Decode(archive.data(), archive.size(), out);
+    double seconds = timer.Seconds();
+
+    if (threads == 1) base = seconds;
+
+    cout << setw(8) << threads
+         << setw(12) << fixed << setprecision(0) << n / seconds
+         << setw(9) << setprecision(2) << base / seconds << endl;
+  }
+
+  return sink ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// A stream of reports: Metar::Create per report vs one reused MetarParser
+//
+
+#include "MetarParser.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static long read(const Metar& metar)
+{
+  long sum = metar.WindSpeed() + metar.Temperature();
+  for (unsigned int i = 0 ; i < metar.NumCloudLayers() ; i++)
+  {
+    sum += metar.CloudLayers()[i].Altitude();
+  }
+
+  return sum + metar.NumPhenomena();
+}
+
+static void report(const char *name, size_t n, double seconds)
+{
+  cout << setw(12) << name
+       << setw(14) << fixed << setprecision(0) << n / seconds << endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+
+  size_t lengths[Bench::NUM_REPORTS];
+  for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+  {
+    lengths[i] = strlen(Bench::REPORTS[i]);
+  }
+
+  const size_t n = passes * Bench::NUM_REPORTS;
+  long sink = 0;
+
+  cout << "               reports/s" << endl;
+
+  Bench::Timer create_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+    {
+      sink += read(*Metar::Create(Bench::REPORTS[i], lengths[i]));
+    }
+  }
+  report("Create", n, create_timer.Seconds());
+
+  auto parser = MetarParser::Create();
+  Bench::Timer parser_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+    {
+      parser->Parse(Bench::REPORTS[i], lengths[i]);
+      sink += read(parser->Report());
+    }
+  }
+  report("MetarParser", n, parser_timer.Seconds());
+
+  return sink ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Weather phenomena group decoding
+//
+
+#include "Phenom.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static size_t run(const char *name, const vector<string>& groups,
+                size_t passes)
+{
+  PhenomGroup group;
+  size_t sink = 0;
+  size_t bytes = 0;
+
+  Bench::Timer timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (const auto& g : groups)
+    {
+      sink += Phenom::Decode(g.data(), g.size(), false, group);
+      bytes += g.size();
+    }
+  }
+  double seconds = timer.Seconds();
+
+  cout << setw(12) << name
+       << setw(12) << fixed << setprecision(0)
+       << groups.size() * passes / seconds
+       << setw(10) << setprecision(1) << bytes / seconds / 1e6 << endl;
+
+  return sink;
+}
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+
+  // typical groups, and cloud / wind / temperature groups that are
+  // tried as phenomena and rejected
+  vector<string> common =
+  {
+    "-RA", "+TSRA", "BR", "FZFG", "VCSH", "-SHRASN", "BLSN", "+SN",
+    "BKN022", "27009KT", "M04/M07", "A3029", "RMK", "AO2"
+  };
+
+  // pathological: very long tokens made of codes and of junk
+  vector<string> in_long =
+  {
+    string(4096, 'R'), string(2048, 'Z') + "RA",
+    [] { string s; for (int i = 0 ; i < 1024 ; i++) s += "SHRA"; return s; }()
+  };
+
+  cout << "      groups    groups/s      MB/s" << endl;
+
+  size_t sink = run("common", common, passes);
+  sink += run("long", in_long, passes / 100);
+
+  return sink ? 0 : 1;
+}
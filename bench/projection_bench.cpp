@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Metar::Decode at several field projections
+//
+
+#include "Metar.h"
+#include "MetarRecord.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static const struct
+{
+  const char *name;
+  uint32_t fields;
+} PROJECTIONS[] =
+{
+  { "all", Metar::ALL_FIELDS },
+  { "no remarks", Metar::ALL_FIELDS & ~Metar::REMARKS },
+  { "no sky", Metar::ALL_FIELDS & ~(Metar::CLOUDS | Metar::PHENOMENA) },
+  { "wind/temp/alt", Metar::WIND | Metar::TEMPERATURE | Metar::PRESSURE },
+  { "wind", Metar::WIND },
+  { "remarks", Metar::REMARKS }
+};
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+
+  size_t lengths[Bench::NUM_REPORTS];
+  for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+  {
+    lengths[i] = strlen(Bench::REPORTS[i]);
+  }
+
+  MetarRecord rec;
+  size_t sink = 0;
+
+  cout << "  projection     reports/s" << endl;
+
+  for (const auto& projection : PROJECTIONS)
+  {
+    Bench::Timer timer;
+    for (size_t p = 0 ; p < passes ; p++)
+    {
+      for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+      {
+        sink += Metar::Decode(Bench::REPORTS[i], lengths[i], rec,
+                              Metar::parse_mode::SEQUENTIAL,
+                              projection.fields);
+      }
+    }
+    double seconds = timer.Seconds();
+
+    cout << setw(14) << projection.name
+         << setw(14) << fixed << setprecision(0)
+         << passes * Bench::NUM_REPORTS / seconds << endl;
+  }
+
+  return sink ? 0 : 1;
+}
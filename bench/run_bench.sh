@@ -0,0 +1,3 @@
+#!/bin/bash
+cd .. && make && cd -
+make && ./thread_bench && ./grammar_bench && ./batch_bench && ./parallel_bench && ./archive_bench && ./charclass_bench && ./phenom_bench && ./clouds_bench && ./utils_bench && ./units_bench && ./digits_bench && ./event_bench && ./projection_bench && ./lazy_bench && ./parser_bench && ./stream_bench
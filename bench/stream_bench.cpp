@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// A feed of reports, one per line: buffer it all and decode each line vs
+// MetarStream pushed in network sized chunks
+//
+
+#include "MetarStream.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static void report(const char *name, size_t n, double seconds)
+{
+  cout << setw(12) << name
+       << setw(14) << fixed << setprecision(0) << n / seconds << endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+
+  string feed;
+  for (size_t i = 0 ; i < Bench::NUM_REPORTS ; i++)
+  {
+    feed += Bench::REPORTS[i];
+    feed += '\n';
+  }
+
+  const size_t n = passes * Bench::NUM_REPORTS;
+  long sink = 0;
+
+  cout << "               reports/s" << endl;
+
+  MetarRecord rec;
+  Bench::Timer buffered_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    string body(feed);
+    const char *line = body.data();
+    const char *end = line + body.size();
+    while (line < end)
+    {
+      const char *eol =
+          static_cast<const char *>(memchr(line, '\n', end - line));
+      Metar::Decode(line, eol - line, rec);
+      sink += rec.wind_spd;
+      line = eol + 1;
+    }
+  }
+  report("buffered", n, buffered_timer.Seconds());
+
+  char buffer[256];
+  MetarStream stream(buffer, sizeof(buffer));
+  auto handler = [&](const char *, size_t, const MetarRecord& r, bool)
+  {
+    sink += r.wind_spd;
+  };
+
+  Bench::Timer stream_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < feed.size() ; i += 64)
+    {
+      stream.Push(feed.data() + i, min<size_t>(64, feed.size() - i),
+                  handler);
+    }
+  }
+  stream.Finish(handler);
+  report("MetarStream", n, stream_timer.Seconds());
+
+  return sink ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Multi-threaded decode throughput
+//
+
+#include "Metar.h"
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static void decode(size_t iterations, unsigned int *sink)
+{
+  unsigned int n = 0;
+  for (size_t i = 0 ; i < iterations ; i++)
+  {
+    auto metar = Metar::Create(Bench::REPORTS[i % Bench::NUM_REPORTS]);
+    n += metar->NumCloudLayers();
+  }
+  *sink = n;
+}
+
+int main(int argc, char **argv)
+{
+  size_t per_thread = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+  unsigned int max_threads = thread::hardware_concurrency();
+  if (max_threads == 0) max_threads = 1;
+
+  cout << "threads   reports/s   speedup" << endl;
+
+  vector<unsigned int> counts;
+  for (unsigned int n = 1 ; n < max_threads ; n *= 2)
+  {
+    counts.push_back(n);
+  }
+  counts.push_back(max_threads);
+
+  double base = 0.0;
+  for (auto n : counts)
+  {
+    vector<thread> workers;
+    vector<unsigned int> sinks(n);
+
+    Bench::Timer timer;
+    for (unsigned int t = 0 ; t < n ; t++)
+    {
+      workers.emplace_back(decode, per_thread, &sinks[t]);
+    }
+    for (auto& w : workers)
+    {
+      w.join();
+    }
+    double rate = (per_thread * n) / timer.Seconds();
+
+    if (n == 1) base = rate;
+
+    cout << setw(7) << n << setw(12) << fixed << setprecision(0) << rate
+         << setw(10) << setprecision(2) << rate / base << endl;
+  }
+
+  return 0;
+}
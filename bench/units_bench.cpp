@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Normalizing a column of wind speeds: switch per element vs Units
+//
+
+#include "Units.h"
+#include "Convert.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static double per_element(Metar::speed_units units, double speed)
+{
+  switch (units)
+  {
+    case Metar::speed_units::KT:
+      return Convert::Kts2Kph(speed);
+
+    case Metar::speed_units::MPS:
+      return speed * 3.6;
+
+    default:
+      return speed;
+  }
+}
+
+static void report(const char *name, size_t n, double seconds)
+{
+  cout << setw(12) << name
+       << setw(14) << fixed << setprecision(0) << n / seconds << endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000;
+
+  const size_t N = 100000;
+
+  vector<double> speed(N), out(N);
+  for (size_t i = 0 ; i < N ; i++)
+  {
+    speed[i] = (i % 60) * 1.0;
+  }
+
+  // the column's units, only known at run time
+  volatile int unit = static_cast<int>(Metar::speed_units::KT);
+  Metar::speed_units units = static_cast<Metar::speed_units>(unit);
+
+  double sink = 0.0;
+
+  cout << "                values/s" << endl;
+
+  Bench::Timer timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    for (size_t i = 0 ; i < N ; i++)
+    {
+      out[i] = per_element(units, speed[i]);
+    }
+    sink += out[p % N];
+  }
+  report("switch", N * passes, timer.Seconds());
+
+  Bench::Timer normalize_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    Units::Normalize<KilometersPerHour>(speed.data(), units, out.data(), N);
+    sink += out[p % N];
+  }
+  report("Normalize", N * passes, normalize_timer.Seconds());
+
+  Bench::Timer convert_timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    Units::Convert<Knots, KilometersPerHour>(speed.data(), out.data(), N);
+    sink += out[p % N];
+  }
+  report("Convert", N * passes, convert_timer.Seconds());
+
+  return sink != 0.0 ? 0 : 1;
+}
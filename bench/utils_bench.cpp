@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Scalar, array and fast approximation versions of the weather utilities
+//
+
+#include "Utils.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+
+#include "bench.h"
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static const size_t N = 100000;
+
+static double sink = 0.0;
+
+//
+// Values per second of fn over every element of the arrays
+//
+template <typename Fn>
+static double rate(size_t passes, vector<double>& out, Fn fn)
+{
+  Bench::Timer timer;
+  for (size_t p = 0 ; p < passes ; p++)
+  {
+    fn();
+  }
+  double seconds = timer.Seconds();
+
+  sink += out[N / 2];
+
+  return N * passes / seconds;
+}
+
+static void report(const char *name, double scalar, double batch,
+                   double fast = 0.0)
+{
+  cout << setw(12) << name << fixed << setprecision(0)
+       << setw(13) << scalar
+       << setw(13) << batch << setw(6) << setprecision(1)
+       << batch / scalar << "x";
+
+  // no fast version
+  if (fast > 0.0)
+  {
+    cout << setprecision(0)
+         << setw(13) << fast << setw(6) << setprecision(1)
+         << fast / scalar << "x";
+  }
+
+  cout << endl;
+}
+
+int main(int argc, char **argv)
+{
+  size_t passes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100;
+
+  vector<double> t(N), td(N), wind(N), rh(N), f(N), out(N);
+  for (size_t i = 0 ; i < N ; i++)
+  {
+    t[i] = -40.0 + (i % 800) * 0.1;
+    td[i] = t[i] - (i % 37) * 0.5;
+    wind[i] = (i % 120) * 1.0;
+    rh[i] = (i % 101) * 1.0;
+    f[i] = 70.0 + (i % 450) * 0.1;
+  }
+
+  cout << "                 scalar/s      batch/s"
+       << "               fast/s" << endl;
+
+  report("Humidity",
+         rate(passes, out, [&] {
+           for (size_t i = 0 ; i < N ; i++)
+             out[i] = Utils::Humidity(t[i], td[i]);
+         }),
+         rate(passes, out, [&] {
+           Utils::Humidity(t.data(), td.data(), out.data(), N);
+         }),
+         rate(passes, out, [&] {
+           for (size_t i = 0 ; i < N ; i++)
+             out[i] = Utils::HumidityFast(t[i], td[i]);
+         }));
+
+  report("WindChill",
+         rate(passes, out, [&] {
+           for (size_t i = 0 ; i < N ; i++)
+             out[i] = Utils::WindChill(t[i], wind[i]);
+         }),
+         rate(passes, out, [&] {
+           Utils::WindChill(t.data(), wind.data(), out.data(), N);
+         }),
+         rate(passes, out, [&] {
+           for (size_t i = 0 ; i < N ; i++)
+             out[i] = Utils::WindChillFast(t[i], wind[i]);
+         }));
+
+  report("HeatIndex",
+         rate(passes, out, [&] {
+           for (size_t i = 0 ; i < N ; i++)
+             out[i] = Utils::HeatIndex(f[i], rh[i]);
+         }),
+         rate(passes, out, [&] {
+           Utils::HeatIndex(f.data(), rh.data(), out.data(), N);
+         }));
+
+  return sink != 0.0 ? 0 : 1;
+}
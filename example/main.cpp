@@ -7,18 +7,17 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
-#include <vector>
 
 #include <cmath>
 #include <getopt.h>
 
-#include <boost/algorithm/string.hpp>
-
 #include "Fetch.h"
 
 #include "Metar.h"
+#include "MetarStream.h"
 #include "Convert.h"
 #include "Utils.h"
+#include "Units.h"
 
 #include "Phenom2String.h"
 
@@ -62,6 +61,31 @@ static const char *cloud_types[] =
   "ACC" 
 };
 
+//
+// This METAR source returns 2 lines of text.
+//   * The first line is the observation time and date (UTC)
+//   * The second line is the METAR string
+// Lines are decoded only far enough to tell the report from the date,
+// and the report is kept.
+//
+struct ReportReceiver
+{
+  char line[512];
+  MetarStream stream{line, sizeof(line), Metar::parse_mode::SEQUENTIAL,
+                     Metar::STATION};
+
+  string metar_str;
+
+  void operator()(const char *metar, size_t len, const MetarRecord& rec,
+                  bool)
+  {
+    if (rec.hasICAO())
+    {
+      metar_str.assign(metar, len);
+    }
+  }
+};
+
 static void print_temp(double temp, bool fahrenheit_flag)
 {
   cout << (fahrenheit_flag ? Convert::c2f(temp) : temp) 
@@ -126,15 +150,11 @@ int main(int argc, char **argv)
       return 1;
     }
 
-    //
-    // This METAR source returns 2 lines of text.
-    //   * The first line is the observation time and date (UTC)
-    //   * The second line is the METAR string
-    //
-    vector<string> list;
-    boost::split(list, data, boost::is_any_of("\n"));
+    ReportReceiver receiver;
+    receiver.stream.Push(data.data(), data.size(), receiver);
+    receiver.stream.Finish(receiver);
 
-    metar_str = list[1].c_str();
+    metar_str = receiver.metar_str;
   }
 
   if (!metar_str.empty())
@@ -157,23 +177,11 @@ int main(int argc, char **argv)
     double feels_like(temp);
     if (metar->hasWindSpeed())
     {
-      double wind_kph;
-      switch(metar->WindSpeedUnits())
-      {
-        case Metar::speed_units::KT:
-          wind_kph = Convert::Kts2Kph(metar->WindSpeed());
-          break;
-
-        case Metar::speed_units::MPS:
-          wind_kph = metar->WindSpeed() / 1000.0;
-          break;
+      Speed<KilometersPerHour> wind =
+        Units::ToSpeed<KilometersPerHour>(metar->WindSpeed(),
+                                          metar->WindSpeedUnits());
 
-        default:
-          wind_kph = metar->WindSpeed();
-          break;
-      }
-      
-      feels_like = Utils::WindChill(temp, wind_kph);
+      feels_like = Utils::WindChill(temp, wind.Value());
     }
 
     if (metar->hasDewPoint() || metar->hasDewPointNA())
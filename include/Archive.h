@@ -0,0 +1,99 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Memory mapped file holding one METAR per line
+//
+
+#ifndef STORAGE_B_WEATHER_ARCHIVE_H_
+#define STORAGE_B_WEATHER_ARCHIVE_H_
+
+#include "defines.h"
+
+#ifndef NO_STD
+
+#include "Metar.h"
+#include "MetarRecord.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Storage_B
+{
+  namespace Weather
+  {
+    class Archive
+    {
+    public:
+      //
+      // Called once per non-empty line with the decoded record, which is
+      // only valid for the duration of the call
+      //
+      typedef std::function<void(const MetarRecord& rec, bool ok)> handler;
+
+      //
+      // Static Creator
+      //    path - file to map read only
+      //
+      //    returns null if the file cannot be opened or mapped (errno is
+      //    left as set by the failing call)
+      //
+      static std::shared_ptr<Archive> Open(const char *path);
+
+      virtual ~Archive() = default;
+
+      Archive(const Archive&) = delete;
+      Archive& operator=(const Archive&) = delete;
+
+      //
+      // Mapped contents, not NUL terminated.  May be handed directly to
+      // ParallelDecoder::Decode().
+      //
+      virtual const char *Data() const = 0;
+      virtual size_t Size() const = 0;
+
+      //
+      // Number of '\n' terminated or final unterminated lines, including
+      // empty ones
+      //
+      virtual size_t NumLines() const = 0;
+
+      //
+      // Decode every non-empty line in file order, reusing one record
+      //    fn      - receives each record
+      //    mode    - group matching strategy
+      //    options - Metar::decode_options and Metar::decode_fields
+      //
+      //    returns the number of lines decoded
+      //
+      virtual size_t Decode(const handler& fn,
+                            Metar::parse_mode mode =
+                                Metar::parse_mode::SEQUENTIAL,
+                            uint32_t options = Metar::DEFAULT) const = 0;
+
+      //
+      // Decode every non-empty line in file order
+      //    out     - replaced by one record per line
+      //    ok      - if not null, replaced by one flag per line, false if
+      //              the line could not be decoded
+      //    mode    - group matching strategy
+      //    options - Metar::decode_options and Metar::decode_fields
+      //
+      //    returns the number of lines decoded
+      //
+      virtual size_t Decode(std::vector<MetarRecord>& out,
+                            std::vector<bool> *ok = nullptr,
+                            Metar::parse_mode mode =
+                                Metar::parse_mode::SEQUENTIAL,
+                            uint32_t options = Metar::DEFAULT) const = 0;
+
+    protected:
+      Archive() = default;
+    };
+  }
+}
+
+#endif
+
+#endif
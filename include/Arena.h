@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Bump allocator for objects created while decoding
+//
+
+#ifndef STORAGE_B_WEATHER_ARENA_H_
+#define STORAGE_B_WEATHER_ARENA_H_
+
+#include "defines.h"
+
+#ifndef NO_STD
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Storage_B
+{
+  namespace Weather
+  {
+    //
+    // Hands out memory from large blocks and frees it all at once.
+    // Objects made with New() are destroyed, newest first, by Release()
+    // or when the arena is destroyed.  Not thread safe.
+    //
+    class Arena
+    {
+    public:
+      static const size_t DEFAULT_BLOCK_SIZE = 16384;
+
+      //
+      // Static Creator
+      //    block_size - bytes requested from the heap at a time
+      //
+      static std::shared_ptr<Arena>
+          Create(size_t block_size = DEFAULT_BLOCK_SIZE);
+
+      explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE);
+
+      //
+      // Use caller owned storage first, then fall back to the heap
+      //    buffer - storage, must outlive the arena
+      //    size   - length of buffer
+      //
+      Arena(void *buffer, size_t size,
+            size_t block_size = DEFAULT_BLOCK_SIZE);
+
+      ~Arena();
+
+      Arena(const Arena&) = delete;
+      Arena& operator=(const Arena&) = delete;
+
+      void *Allocate(size_t size,
+                     size_t align = alignof(std::max_align_t));
+
+      template <typename T, typename... Args>
+      T *New(Args&&... args)
+      {
+        Finalizer *f = nullptr;
+        if (!std::is_trivially_destructible<T>::value)
+        {
+          f = static_cast<Finalizer *>(
+              Allocate(sizeof(Finalizer), alignof(Finalizer)));
+        }
+
+        T *obj = new (Allocate(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...);
+
+        if (f)
+        {
+          f->destroy = [](void *p) { static_cast<T *>(p)->~T(); };
+          f->obj = obj;
+          f->next = _finalizers;
+          _finalizers = f;
+        }
+
+        return obj;
+      }
+
+      //
+      // Destroy every object and return every heap block
+      //
+      void Release();
+
+      //
+      // Release(), then use new caller owned storage first
+      //    buffer - storage, must outlive the arena
+      //    size   - length of buffer
+      //
+      void Reset(void *buffer, size_t size);
+
+      //
+      // Heap blocks currently held
+      //
+      size_t NumBlocks() const { return _num_blocks; }
+
+      //
+      // Upper bound on the arena space New() uses for an object of size
+      // bytes, with alignment no stricter than std::max_align_t
+      //
+      static constexpr size_t Footprint(size_t size)
+      {
+        return size + sizeof(Finalizer)
+             + alignof(std::max_align_t) + alignof(Finalizer);
+      }
+
+    private:
+      struct Block
+      {
+        Block *next;
+      };
+
+      struct Finalizer
+      {
+        void (*destroy)(void *);
+        void *obj;
+        Finalizer *next;
+      };
+
+      void add_block(size_t min_size);
+
+      char *_buffer;
+      size_t _buffer_size;
+      size_t _block_size;
+
+      char *_pos;
+      char *_end;
+
+      Block *_blocks;
+      size_t _num_blocks;
+
+      Finalizer *_finalizers;
+    };
+  }
+}
+
+#endif
+
+#endif
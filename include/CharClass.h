@@ -0,0 +1,59 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Character classification of report text, 64 bytes at a time
+//
+
+#ifndef STORAGE_B_WEATHER_CHAR_CLASS_H_
+#define STORAGE_B_WEATHER_CHAR_CLASS_H_
+
+#include "defines.h"
+
+#ifndef NO_STD
+#include <cstddef>
+#include <cstdint>
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+namespace Storage_B
+{
+  namespace Weather
+  {
+    class CharClass
+    {
+    public:
+      static const size_t BLOCK_SIZE = 64;
+
+      //
+      // Bit i of each mask describes byte i of the block.  Bits past the
+      // end of a short block are clear.
+      //
+      struct Masks
+      {
+        uint64_t space;   // ' '
+        uint64_t digit;   // '0' - '9'
+        uint64_t alpha;   // 'A' - 'Z', 'a' - 'z'
+      };
+
+      //
+      // Classify min(len, BLOCK_SIZE) bytes of str, using SSE2 or AVX2
+      // when the target supports them.  Never reads past str + len.
+      //
+      static Masks Classify(const char *str, size_t len);
+
+      //
+      // Byte at a time reference implementation
+      //
+      static Masks ClassifyScalar(const char *str, size_t len);
+
+      CharClass() = delete;
+      CharClass(const CharClass&) = delete;
+      CharClass& operator=(const CharClass&) = delete;
+      ~CharClass() = default;
+    };
+  }
+}
+
+#endif
@@ -10,13 +10,26 @@
 #include "defines.h"
 
 #ifndef NO_STD
+#include <cstddef>
+#include <cstdint>
+#include <climits>
 #include <memory>
+#else
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
 #endif
 
 namespace Storage_B
 {
   namespace Weather
   {
+    struct CloudLayer;
+
+#ifndef NO_STD
+    class Arena;
+#endif
+
     class Clouds
     {
     public:
@@ -47,6 +60,51 @@ namespace Storage_B
 #endif
               Create(const char *str, bool temp = false);
 
+      //
+      // As above, str need not be NUL terminated
+      //
+      static
+#ifndef NO_STD
+          std::shared_ptr<Clouds>
+#else
+          Clouds *
+#endif
+              Create(const char *str, size_t len, bool temp = false);
+
+      //
+      // Static Creator
+      //    layer - decoded cloud layer
+      //
+      static
+#ifndef NO_STD
+          std::shared_ptr<Clouds>
+#else
+          Clouds *
+#endif
+              Create(const CloudLayer& layer);
+
+#ifndef NO_STD
+      //
+      // Static Creator
+      //    layer - decoded cloud layer
+      //    arena - owns the result, which lives until the arena is
+      //            released
+      //
+      static Clouds *Create(const CloudLayer& layer, Arena& arena);
+
+      //
+      // Arena space one Create(layer, arena) takes at most
+      //
+      static size_t ArenaSize();
+#endif
+
+      //
+      // Decode a cloud layer group without allocating
+      //    returns false if str is not a cloud layer group
+      //
+      static bool Decode(const char *str, size_t len, bool temp,
+                         CloudLayer& layer);
+
       virtual ~Clouds() = default;
 
       virtual cover Cover() const = 0;
@@ -62,6 +120,36 @@ namespace Storage_B
 
       virtual bool Temporary() const = 0;
     };
+
+    //
+    // Plain value form of a cloud layer, packed into 4 bytes.  The
+    // accessors mirror the Clouds interface.
+    //
+    struct CloudLayer
+    {
+      static const uint16_t NO_ALTITUDE = 0xFFFF;
+
+      Clouds::cover Cover() const
+      {
+        return static_cast<Clouds::cover>(cover);
+      }
+
+      int Altitude() const { return hasAltitude() ? altitude : INT_MIN; }
+      bool hasAltitude() const { return altitude != NO_ALTITUDE; }
+
+      Clouds::type CloudType() const
+      {
+        return static_cast<Clouds::type>(static_cast<int>(type) - 1);
+      }
+      bool hasCloudType() const { return type != 0; }
+
+      bool Temporary() const { return temporary; }
+
+      uint16_t altitude;       // NO_ALTITUDE if not reported
+      uint8_t cover;           // Clouds::cover
+      uint8_t type : 7;        // Clouds::type + 1
+      uint8_t temporary : 1;
+    };
   }
 }
 
@@ -0,0 +1,1001 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Event driven METAR decoder: reports each group to a handler as it is
+// recognised, without building a Metar or a MetarRecord
+//
+
+#ifndef STORAGE_B_WEATHER_EVENT_DECODER_H_
+#define STORAGE_B_WEATHER_EVENT_DECODER_H_
+
+#include "Metar.h"
+#include "MetarRecord.h"
+#include "CharClass.h"
+
+#ifndef NO_STD
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#else
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#endif
+
+namespace Storage_B
+{
+  namespace Weather
+  {
+    //
+    // A group EventDecoder::Decode found but left for EventDecoder::Replay
+    //
+    struct DeferredGroup
+    {
+      size_t offset;      // from the start of the report
+      size_t len;
+      uint32_t fields;    // the Metar::decode_fields it holds
+      unsigned int group; // how Decode matched it, for Replay
+    };
+
+    //
+    // Callbacks of EventDecoder::Decode.  Derive from this and hide the
+    // callbacks of interest; the others do nothing and compile away.
+    // Values are in the units and scales of the MetarRecord fields of
+    // the same name, MetarRecord::INTEGER_UNDEFINED where the group
+    // leaves them out.
+    //
+    struct MetarHandler
+    {
+      void on_message_type(Metar::message_type) {}
+
+      // the four letters, not NUL terminated
+      void on_icao(const char *) {}
+
+      void on_time(int /* day */, int /* hour */, int /* minute */) {}
+
+      // direction undefined if variable, gust undefined if not reported
+      void on_wind(int /* dir */, int /* speed */, int /* gust */,
+                   Metar::speed_units, bool /* vrb */) {}
+
+      void on_wind_var(int /* min_dir */, int /* max_dir */) {}
+
+      // meters, or 1/16 SM (see MetarRecord::VIS_SM_SCALE)
+      void on_visibility(int, Metar::distance_units, bool /* lt */) {}
+
+      void on_cavok() {}
+
+      void on_vertical_visibility(int) {}
+
+#ifndef NO_CLOUDS
+      void on_cloud_layer(const CloudLayer&) {}
+#endif
+
+#ifndef NO_PHENOM
+      void on_phenom(const PhenomGroup&) {}
+#endif
+
+      void on_temperature(int /* temp */, int /* dew */) {}
+
+      // hundredths of inHg
+      void on_altimeter_a(int) {}
+
+      // hPa
+      void on_altimeter_q(int) {}
+
+      // tenths of hPa
+      void on_sea_level_pressure(int) {}
+
+      // tenths of a degree C, from the T remark group
+      void on_temperature_na(int /* temp */, int /* dew */) {}
+
+      void on_tempo() {}
+
+      // the RMK group, remarks follow it to the end of the report
+      void on_remarks(const char * /* rmk */) {}
+
+      // a group holding deferred fields, in report order
+      void on_deferred(const DeferredGroup&) {}
+    };
+
+    //
+    // Implementation of EventDecoder, not part of the interface
+    //
+    namespace Detail
+    {
+      const char *const WIND_SPEED_KT = "KT";
+      const char *const WIND_SPEED_MPS = "MPS";
+      const char *const WIND_SPEED_KPH = "KPH";
+
+      const char *const VIS_UNITS_SM = "SM";
+
+      //
+      // A report group: points into the caller's buffer, which is neither
+      // modified nor required to be NUL terminated.  Bit i of digit / alpha
+      // classifies str[i], for the first 64 characters.
+      //
+      struct Token
+      {
+        const char *str;
+        size_t len;
+
+        uint64_t digit;
+        uint64_t alpha;
+
+        const char *end() const { return str + len; }
+      };
+
+      //
+      // Bit i set if pattern[i] == c, for the first n characters
+      //
+      constexpr uint64_t pattern_mask(const char *pattern, char c, size_t n)
+      {
+        return n == 0 ? 0
+             : ((pattern[n - 1] == c) ? (uint64_t(1) << (n - 1)) : 0)
+               | pattern_mask(pattern, c, n - 1);
+      }
+
+      //
+      // A group pattern: '#' matches a digit, '$' a letter, anything else
+      // itself.  Built at compile time from a string literal, so its length
+      // and per-position class masks are constants and matching a token is
+      // a length check, a pair of mask compares and the literal characters.
+      //
+      template <size_t N>
+      struct Pattern
+      {
+        static_assert(N - 1 < 64, "pattern longer than a class mask");
+
+        static constexpr size_t LEN = N - 1;
+
+        const char *str;
+
+        uint64_t digit;
+        uint64_t alpha;
+        uint64_t literal;
+      };
+
+      template <size_t N>
+      constexpr Pattern<N> pattern(const char (&str)[N])
+      {
+        return Pattern<N>
+        {
+          str,
+          pattern_mask(str, '#', N - 1),
+          pattern_mask(str, '$', N - 1),
+          ((uint64_t(1) << (N - 1)) - 1)
+              & ~(pattern_mask(str, '#', N - 1) | pattern_mask(str, '$', N - 1))
+        };
+      }
+
+      template <size_t N>
+      inline bool match_classes(const Pattern<N>& pattern, const Token& tok)
+      {
+        if (((tok.digit & pattern.digit) != pattern.digit)
+         || ((tok.alpha & pattern.alpha) != pattern.alpha))
+        {
+          return false;
+        }
+
+        for (uint64_t m = pattern.literal ; m ; m &= m - 1)
+        {
+          size_t i = __builtin_ctzll(m);
+          if (pattern.str[i] != tok.str[i]) return false;
+        }
+
+        return true;
+      }
+
+      template <size_t N>
+      inline bool match(const Pattern<N>& pattern, const Token& tok)
+      {
+        return (tok.len == Pattern<N>::LEN) && match_classes(pattern, tok);
+      }
+
+      template <size_t N>
+      inline bool starts_with(const Pattern<N>& pattern, const Token& tok)
+      {
+        return (tok.len >= Pattern<N>::LEN) && match_classes(pattern, tok);
+      }
+
+      constexpr auto DIGIT = pattern("#");
+      constexpr auto ICAO = pattern("$$$$");
+      constexpr auto OT = pattern("######Z");
+      constexpr auto WIND = pattern("#####");
+      constexpr auto WIND_GUST = pattern("#####G##");
+      constexpr auto WIND_GUST_3 = pattern("######G###");
+      constexpr auto WIND_VRB = pattern("VRB");
+      constexpr auto WIND_VAR = pattern("###V###");
+      constexpr auto VIS_M = pattern("####");
+      constexpr auto VERT_VIS = pattern("VV###");
+      constexpr auto TEMP = pattern("##/##");
+      constexpr auto TEMP_M = pattern("##/M##");
+      constexpr auto TEMP_MM = pattern("M##/M##");
+      constexpr auto TEMP_ONLY = pattern("##/");
+      constexpr auto TEMP_ONLY_M = pattern("M##/");
+      constexpr auto ALT_A = pattern("A####");
+      constexpr auto ALT_Q = pattern("Q####");
+      constexpr auto SLP = pattern("SLP###");
+      constexpr auto TEMP_NA = pattern("T####");
+
+      inline bool equals(const Token& tok, const char *str)
+      {
+        size_t len = strlen(str);
+        return (tok.len == len) && !memcmp(tok.str, str, len);
+      }
+
+      //
+      // Bounded strstr(): first occurrence of str within the token
+      //
+      inline const char *find(const Token& tok, const char *str)
+      {
+        size_t len = strlen(str);
+        for (size_t i = 0 ; i + len <= tok.len ; i++)
+        {
+          if (!memcmp(tok.str + i, str, len)) return tok.str + i;
+        }
+
+        return nullptr;
+      }
+
+      //
+      // Bounded atoi(): reads at most len leading digits
+      //
+      inline int to_int(const char *str, size_t len)
+      {
+        int val = 0;
+        for (size_t i = 0 ; (i < len) && isdigit(str[i]) ; i++)
+        {
+          val = (val * 10) + (str[i] - '0');
+        }
+
+        return val;
+      }
+
+      inline size_t min_len(size_t a, size_t b)
+      {
+        return a < b ? a : b;
+      }
+
+      //
+      // Fixed width decoders for fields the group pattern has already
+      // classified as digits: no bounds or class checks, no loop.  Only
+      // used where they measurably beat to_int() (wind variation, metre
+      // visibility, temperature).
+      //
+      inline int digits2(const char *p)
+      {
+        return ((p[0] - '0') * 10) + (p[1] - '0');
+      }
+
+      inline int digits3(const char *p)
+      {
+        return (digits2(p) * 10) + (p[2] - '0');
+      }
+
+      inline int digits4(const char *p)
+      {
+        return (digits2(p) * 100) + digits2(p + 2);
+      }
+
+      // two digits, negative with an 'M' prefix
+      inline int signed2(const char *p)
+      {
+        return (p[0] == 'M') ? -digits2(p + 1) : digits2(p);
+      }
+
+      inline bool is_message_type(const Token& tok)
+      {
+        return equals(tok, "METAR") || equals(tok, "SPECI");
+      }
+
+      inline bool is_icao(const Token& tok)
+      {
+        return match(ICAO, tok);
+      }
+
+      inline bool is_ot(const Token& tok)
+      {
+        return match(OT, tok);
+      }
+
+      inline bool is_wind(const Token& tok)
+      {
+        return starts_with(WIND, tok) 
+            || starts_with(WIND_GUST, tok) 
+            || starts_with(WIND_GUST_3, tok)
+            || starts_with(WIND_VRB, tok);
+      }
+
+      inline bool is_wind_var(const Token& tok)
+      {
+        return match(WIND_VAR, tok);
+      }
+
+      inline bool is_vis(const Token& tok)
+      {
+        if (equals(tok, "CAVOK"))
+          return true;
+
+        const char *p = find(tok, VIS_UNITS_SM);
+        if (!p)
+        {  
+          return match(VIS_M, tok);
+        }
+
+        if ((tok.end() - p) == 2)
+        {
+          const char *str = tok.str;
+          if (!isdigit(str[0]) && (str[0] != 'M')) return false;
+          for (size_t i = 1 ; i < tok.len - 2 ; i++)
+          {
+            if (!isdigit(str[i]) && str[i] != '/') return false;
+          }
+
+          return true;
+        }
+
+        return false;
+      }
+
+      inline bool is_vert_vis(const Token& tok)
+      {
+        return match(VERT_VIS, tok);
+      }
+
+      inline bool is_temp(const Token& tok)
+      {
+        return match(TEMP, tok) 
+          || match(TEMP_M, tok) 
+          || match(TEMP_MM, tok)
+          || match(TEMP_ONLY, tok)
+          || match(TEMP_ONLY_M, tok);
+      }
+
+      inline bool is_altA(const Token& tok)
+      {
+        return match(ALT_A, tok);
+      }
+
+      inline bool is_altQ(const Token& tok)
+      {
+        return match(ALT_Q, tok);
+      }
+
+      inline bool is_rmk(const Token& tok)
+      {
+        return equals(tok, "RMK");
+      }
+
+      inline bool is_tempo(const Token& tok)
+      {
+        return equals(tok, "TEMPO");
+      }
+
+      inline bool is_slp(const Token& tok)
+      {
+        return match(SLP, tok);
+      }
+
+      inline bool is_tempNA(const Token& tok)
+      {
+        return starts_with(TEMP_NA, tok);
+      }
+
+      // tenths of a degree
+      inline int tempNA(const char *val, size_t len)
+      {
+        if (len && (val[0] == '1')) return -to_int(val + 1, len - 1);
+        return to_int(val, len);
+      }
+
+      //
+      // Reentrant replacement for strtok(): the scan position is kept in
+      // the tokenizer instead of in hidden static state, so reports can be
+      // decoded on several threads at once.  The input is never written to.
+      //
+      // The report is classified a block at a time (see CharClass.h); token
+      // boundaries come from the space mask, and every token carries its
+      // digit and letter masks for match().
+      //
+      class Tokenizer
+      {
+      public:
+        Tokenizer(const char *str, size_t len)
+          : _str(str)
+          , _len(len)
+          , _pos(0)
+          , _base(0)
+          , _cur(classify(0))
+          , _next(classify(CharClass::BLOCK_SIZE))
+        {
+        }
+
+        Tokenizer(const Tokenizer&) = delete;
+        Tokenizer& operator=(const Tokenizer&) = delete;
+
+        bool next(Token& tok);
+
+      private:
+        CharClass::Masks classify(size_t offset) const
+        {
+          if (offset >= _len)
+          {
+            CharClass::Masks none = { 0, 0, 0 };
+            return none;
+          }
+
+          return CharClass::Classify(_str + offset, _len - offset);
+        }
+
+        void advance()
+        {
+          _base += CharClass::BLOCK_SIZE;
+          _cur = _next;
+          _next = classify(_base + CharClass::BLOCK_SIZE);
+        }
+
+        // 64 bits of a mask starting at _pos, spanning _cur and _next
+        uint64_t window(uint64_t CharClass::Masks::*mask) const
+        {
+          size_t shift = _pos - _base;
+          if (!shift) return _cur.*mask;
+          return (_cur.*mask >> shift) | (_next.*mask << (64 - shift));
+        }
+
+        const char *_str;
+        size_t _len;
+
+        size_t _pos;
+        size_t _base;   // offset of the block in _cur
+
+        CharClass::Masks _cur;
+        CharClass::Masks _next;
+      };
+
+      inline bool Tokenizer::next(Token& tok)
+      {
+        // skip delimiters
+        for (;;)
+        {
+          if (_pos >= _len) return false;
+          if (_pos - _base >= CharClass::BLOCK_SIZE)
+          {
+            advance();
+            continue;
+          }
+
+          uint64_t rest = ~_cur.space >> (_pos - _base);
+          if (rest)
+          {
+            _pos += __builtin_ctzll(rest);
+            break;
+          }
+          _pos = _base + CharClass::BLOCK_SIZE;
+        }
+
+        if (_pos >= _len) return false;
+
+        tok.str = _str + _pos;
+        tok.digit = window(&CharClass::Masks::digit);
+        tok.alpha = window(&CharClass::Masks::alpha);
+
+        // find the end
+        for (;;)
+        {
+          if (_pos - _base >= CharClass::BLOCK_SIZE) advance();
+
+          uint64_t rest = _cur.space >> (_pos - _base);
+          if (rest)
+          {
+            _pos += __builtin_ctzll(rest);
+            break;
+          }
+
+          _pos = _base + CharClass::BLOCK_SIZE;
+          if (_pos >= _len) break;
+        }
+
+        if (_pos > _len) _pos = _len;
+        tok.len = (_str + _pos) - tok.str;
+
+        return true;
+      }
+
+      //
+      // Matches the groups of a report and hands each one to Handler
+      //
+      template <typename Handler>
+      class GroupParser
+      {
+      public:
+        //
+        // fields   - Metar::decode_fields to decode, 0 for all
+        // deferred - sky and remark fields to pass to on_deferred()
+        //
+        GroupParser(Handler& handler, uint32_t fields, uint32_t deferred = 0)
+          : _handler(handler)
+          , _fields((fields & Metar::ALL_FIELDS) ? fields : Metar::ALL_FIELDS)
+          , _deferred(deferred & _DEFERRABLE & ~_fields)
+          , _seen(0)
+          , _rmk(false)
+          , _tempo(false)
+          , _previous_element{nullptr, 0, 0, 0}
+        {
+        }
+
+        GroupParser(const GroupParser&) = delete;
+        GroupParser& operator=(const GroupParser&) = delete;
+
+        bool parse(const char *metar_str, size_t len,
+                   Metar::parse_mode mode, unsigned int *predicate_calls);
+
+        void replay(const char *metar_str, const DeferredGroup *groups,
+                    size_t n, uint32_t fields);
+
+      private:
+        void defer(const char *metar_str, const Token& tok, uint32_t fields,
+                   size_t group)
+        {
+          if (fields & _deferred)
+          {
+            DeferredGroup deferred =
+            {
+              static_cast<size_t>(tok.str - metar_str), tok.len,
+              fields & _deferred, static_cast<unsigned int>(group)
+            };
+            _handler.on_deferred(deferred);
+          }
+        }
+
+        size_t match_group(const Token& tok, size_t first,
+                           unsigned int& calls) const;
+
+        void parse_message_type(const Token& tok)
+        {
+          _handler.on_message_type(tok.str[0] == 'S'
+              ? Metar::message_type::SPECI : Metar::message_type::METAR);
+        }
+
+        void parse_icao(const Token& tok) { _handler.on_icao(tok.str); }
+
+        void parse_ot(const Token& tok)
+        {
+          _handler.on_time(to_int(tok.str, 2), to_int(tok.str + 2, 2),
+                           to_int(tok.str + 4, 2));
+        }
+
+        void parse_wind(const Token& tok);
+
+        void parse_wind_var(const Token& tok)
+        {
+          _handler.on_wind_var(digits3(tok.str), digits3(tok.str + 4));
+        }
+
+        void parse_vis(const Token& tok);
+
+        bool parse_cloud_layer(const Token& tok);
+
+        void parse_vert_vis(const Token& tok)
+        {
+          _handler.on_vertical_visibility(to_int(tok.str + 2, 3) * 100);
+        }
+
+        void parse_temp(const Token& tok);
+
+        void parse_alt(const Token& tok)
+        {
+          int val = to_int(tok.str + 1, tok.len - 1);
+          if (tok.str[0] == 'Q')
+            _handler.on_altimeter_q(val);
+          else
+            _handler.on_altimeter_a(val);
+        }
+
+        void parse_slp(const Token& tok)
+        {
+          _handler.on_sea_level_pressure(to_int(tok.str + 3, tok.len - 3)
+                                         + 10000);
+        }
+
+        void parse_tempNA(const Token& tok);
+
+        bool parse_phenom(const Token& tok);
+
+        void parse_tempo(const Token&)
+        {
+          _tempo = true;
+          _handler.on_tempo();
+        }
+
+        void parse_rmk(const Token& tok)
+        {
+          _rmk = true;
+          _handler.on_remarks(tok.str);
+        }
+
+        Handler& _handler;
+
+        uint32_t _fields;
+        uint32_t _deferred;
+
+        // bit g set once _GROUPS[g] has been decoded
+        unsigned int _seen;
+
+        bool _rmk;
+        bool _tempo;
+
+        Token _previous_element;
+
+        //
+        // Report groups in the order they appear in a METAR, and the
+        // fields that need them decoded
+        //
+        struct Group
+        {
+          bool (*is)(const Token&);
+          void (GroupParser::*parse)(const Token&);
+          uint32_t fields;
+        };
+
+        static const Group _GROUPS[];
+        static const size_t _NUM_GROUPS;
+        static const size_t _SKY_GROUP;
+
+        // none of their groups look at the ones around them
+        static const uint32_t _DEFERRABLE =
+            Metar::CLOUDS | Metar::PHENOMENA | Metar::REMARKS;
+      };
+
+      template <typename Handler>
+      const typename GroupParser<Handler>::Group
+          GroupParser<Handler>::_GROUPS[] =
+      {
+        {
+          is_message_type, &GroupParser::parse_message_type,
+          Metar::MESSAGE_TYPE
+        },
+        { is_icao, &GroupParser::parse_icao, Metar::STATION },
+        { is_ot, &GroupParser::parse_ot, Metar::TIME },
+        { is_wind, &GroupParser::parse_wind, Metar::WIND },
+        { is_wind_var, &GroupParser::parse_wind_var, Metar::WIND },
+        { is_vis, &GroupParser::parse_vis, Metar::VISIBILITY },
+        { is_vert_vis, &GroupParser::parse_vert_vis, Metar::CLOUDS },
+        { is_temp, &GroupParser::parse_temp, Metar::TEMPERATURE },
+        { is_altA, &GroupParser::parse_alt, Metar::PRESSURE },
+        { is_altQ, &GroupParser::parse_alt, Metar::PRESSURE },
+        {
+          is_tempo, &GroupParser::parse_tempo,
+          Metar::CLOUDS | Metar::PHENOMENA
+        },
+        { is_rmk, &GroupParser::parse_rmk, Metar::ALL_FIELDS },
+        { is_slp, &GroupParser::parse_slp, Metar::SEA_LEVEL_PRESSURE },
+        { is_tempNA, &GroupParser::parse_tempNA, Metar::TEMPERATURE_NA }
+      };
+
+      template <typename Handler>
+      const size_t GroupParser<Handler>::_NUM_GROUPS =
+          sizeof(_GROUPS) / sizeof(_GROUPS[0]);
+
+      // cloud layers and weather phenomena share this position with VV
+      template <typename Handler>
+      const size_t GroupParser<Handler>::_SKY_GROUP = 6;
+
+      //
+      // Returns true if at least one group was decoded
+      //
+      template <typename Handler>
+      bool GroupParser<Handler>::parse(const char *metar_str, size_t len,
+                                       Metar::parse_mode mode,
+                                       unsigned int *predicate_calls)
+      {
+        Tokenizer tokens(metar_str, len);
+
+        unsigned int calls = 0;
+        bool decoded = false;
+
+        // first group that may legally come next
+        size_t pos = 0;
+
+        Token el;
+        while (tokens.next(el))
+        {
+          size_t first = (mode == Metar::parse_mode::GRAMMAR) ? pos : 0;
+
+          const size_t g = match_group(el, first, calls);
+          if (g == _NUM_GROUPS && !_rmk)
+          {
+            if (parse_cloud_layer(el) | parse_phenom(el))
+            {
+              if (pos < _SKY_GROUP) pos = _SKY_GROUP;
+              decoded = true;
+            }
+            else
+            {
+              defer(metar_str, el, Metar::CLOUDS | Metar::PHENOMENA,
+                    _NUM_GROUPS);
+            }
+          }
+
+          if (g < _NUM_GROUPS)
+          {
+            _seen |= 1U << g;
+            if (_GROUPS[g].fields & _fields)
+            {
+              (this->*_GROUPS[g].parse)(el);
+            }
+            else
+            {
+              defer(metar_str, el, _GROUPS[g].fields, g);
+            }
+            if (g >= pos) pos = g + 1;
+            decoded = true;
+
+            // nothing wanted in the remarks
+            if (_rmk && !((_fields | _deferred) & Metar::REMARKS)) break;
+          }
+
+          _previous_element = el;
+        }
+
+        if (predicate_calls)
+        {
+          *predicate_calls = calls;
+        }
+
+        return decoded;
+      }
+
+      //
+      // Decodes the groups holding fields as parse() would have
+      //
+      template <typename Handler>
+      void GroupParser<Handler>::replay(const char *metar_str,
+                                        const DeferredGroup *groups,
+                                        size_t n, uint32_t fields)
+      {
+        for (size_t i = 0 ; i < n ; i++)
+        {
+          if (!(groups[i].fields & fields)) continue;
+
+          Token tok { metar_str + groups[i].offset, groups[i].len, 0, 0 };
+          if (groups[i].group < _NUM_GROUPS)
+          {
+            (this->*_GROUPS[groups[i].group].parse)(tok);
+          }
+          else
+          {
+            parse_cloud_layer(tok);
+            parse_phenom(tok);
+          }
+        }
+      }
+
+      //
+      // Index of the first group that is still pending and matches tok,
+      // trying [first, _NUM_GROUPS) and then, for out of order reports,
+      // [0, first) ahead of the sky groups as SEQUENTIAL does; or
+      // _NUM_GROUPS
+      //
+      template <typename Handler>
+      size_t GroupParser<Handler>::match_group(const Token& tok,
+                                               size_t first,
+                                               unsigned int& calls) const
+      {
+        for (size_t i = 0 ; i < _NUM_GROUPS ; i++)
+        {
+          size_t g = first + i;
+          if (g >= _NUM_GROUPS) g -= _NUM_GROUPS;
+
+          if (!(_seen & (1U << g)))
+          {
+            calls++;
+            if (_GROUPS[g].is(tok)) return g;
+          }
+        }
+
+        return _NUM_GROUPS;
+      }
+
+      template <typename Handler>
+      void GroupParser<Handler>::parse_wind(const Token& tok)
+      {
+        Metar::speed_units units = Metar::speed_units::undefined;
+        if (find(tok, WIND_SPEED_MPS))
+        {
+          units = Metar::speed_units::MPS;
+        }
+        else if (find(tok, WIND_SPEED_KPH))
+        {
+          units = Metar::speed_units::KPH;
+        }
+        else if (find(tok, WIND_SPEED_KT))
+        {
+          units = Metar::speed_units::KT;
+        }
+
+        bool vrb = find(tok, "VRB") != nullptr;
+        int dir = vrb ? MetarRecord::INTEGER_UNDEFINED : to_int(tok.str, 3);
+
+        const char *g = find(tok, "G");
+        int gust = g ? to_int(g + 1, min_len(3, tok.end() - g - 1))
+                     : MetarRecord::INTEGER_UNDEFINED;
+
+        _handler.on_wind(dir, to_int(tok.str + 3, min_len(3, tok.len - 3)),
+                         gust, units, vrb);
+      }
+
+      template <typename Handler>
+      void GroupParser<Handler>::parse_vis(const Token& tok)
+      {
+        if (equals(tok, "CAVOK"))
+        {
+          _handler.on_cavok();
+          return;
+        }
+
+        if (!find(tok, VIS_UNITS_SM))
+        {
+          _handler.on_visibility(digits4(tok.str),
+                                 Metar::distance_units::M, false);
+          return;
+        }
+
+        const int scale = MetarRecord::VIS_SM_SCALE;
+
+        const char *str = tok.str;
+        const char *u = find(tok, VIS_UNITS_SM);
+        Token num { str, static_cast<size_t>(u - str), 0, 0 };
+        const char *p = find(num, "/");
+
+        if (!p)
+        {
+          _handler.on_visibility(to_int(str, num.len) * scale,
+                                 Metar::distance_units::SM, false);
+          return;
+        }
+
+        bool lt = false;
+        int numerator;
+        if (str[0] == 'M')
+        {
+          numerator = to_int(str + 1, p - str - 1);
+          lt = true;
+        }
+        else
+        {
+          numerator = to_int(str, p - str);
+        }
+
+        int denominator = to_int(p + 1, u - p - 1);
+
+        // rounded to the nearest sixteenth
+        int vis = denominator
+            ? ((numerator * scale) + (denominator / 2)) / denominator : 0;
+
+        // whole miles of a split group, e.g. 1 1/2SM
+        if (match(DIGIT, _previous_element))
+        {
+          vis += to_int(_previous_element.str, 1) * scale;
+        }
+
+        _handler.on_visibility(vis, Metar::distance_units::SM, lt);
+      }
+
+      template <typename Handler>
+      bool GroupParser<Handler>::parse_cloud_layer(const Token& tok)
+      {
+#ifndef NO_CLOUDS
+        CloudLayer layer;
+        if ((_fields & Metar::CLOUDS)
+         && Clouds::Decode(tok.str, tok.len, _tempo, layer))
+        {
+          _handler.on_cloud_layer(layer);
+          return true;
+        }
+#else
+        (void)tok;
+#endif
+
+        return false;
+      }
+
+      template <typename Handler>
+      void GroupParser<Handler>::parse_temp(const Token& tok)
+      {
+        // the patterns fix the position of the '/'
+        const char *p = tok.str + ((tok.str[0] == 'M') ? 3 : 2);
+
+        _handler.on_temperature(signed2(tok.str), (p + 1 != tok.end())
+            ? signed2(p + 1) : MetarRecord::INTEGER_UNDEFINED);
+      }
+
+      template <typename Handler>
+      void GroupParser<Handler>::parse_tempNA(const Token& tok)
+      {
+        int dew = MetarRecord::INTEGER_UNDEFINED;
+        if (tok.len > 5)
+        {
+          dew = tempNA(tok.str + 5, min_len(4, tok.len - 5));
+        }
+
+        _handler.on_temperature_na(tempNA(tok.str + 1, 4), dew);
+      }
+
+      template <typename Handler>
+      bool GroupParser<Handler>::parse_phenom(const Token& tok)
+      {
+#ifndef NO_PHENOM
+        PhenomGroup group;
+        if ((_fields & Metar::PHENOMENA)
+         && Phenom::Decode(tok.str, tok.len, _tempo, group))
+        {
+          _handler.on_phenom(group);
+          return true;
+        }
+#else
+        (void)tok;
+#endif
+
+        return false;
+      }
+    }
+
+    class EventDecoder
+    {
+    public:
+      //
+      // Decode a report, calling handler for every group in report order.
+      // Nothing is allocated and no Metar or MetarRecord is built.
+      //    metar_str       - report, need not be NUL terminated
+      //    len             - length of metar_str
+      //    handler         - see MetarHandler
+      //    mode            - group matching strategy
+      //    predicate_calls - if not null, set to the number of group
+      //                      predicates evaluated
+      //    fields          - Metar::decode_fields to report, 0 for all
+      //    deferred        - CLOUDS, PHENOMENA or REMARKS fields left out
+      //                      of fields whose groups are passed to
+      //                      handler.on_deferred() undecoded
+      //
+      //    returns true if at least one group was decoded
+      //
+      template <typename Handler>
+      static bool Decode(const char *metar_str, size_t len, Handler& handler,
+                         Metar::parse_mode mode =
+                             Metar::parse_mode::SEQUENTIAL,
+                         unsigned int *predicate_calls = nullptr,
+                         uint32_t fields = Metar::ALL_FIELDS,
+                         uint32_t deferred = 0)
+      {
+        Detail::GroupParser<Handler> parser(handler, fields, deferred);
+        return parser.parse(metar_str, len, mode, predicate_calls);
+      }
+
+      //
+      // Decode the groups Decode() deferred, calling handler as Decode()
+      // would have
+      //    metar_str - the report given to Decode()
+      //    groups    - the groups passed to on_deferred(), in order
+      //    n         - number of groups
+      //    fields    - decode only the groups holding these fields
+      //
+      template <typename Handler>
+      static void Replay(const char *metar_str, const DeferredGroup *groups,
+                         size_t n, Handler& handler,
+                         uint32_t fields = Metar::ALL_FIELDS)
+      {
+        Detail::GroupParser<Handler> parser(handler, fields);
+        parser.replay(metar_str, groups, n, fields);
+      }
+
+      EventDecoder() = delete;
+      EventDecoder(const EventDecoder&) = delete;
+      EventDecoder& operator=(const EventDecoder&) = delete;
+      ~EventDecoder() = default;
+    };
+  }
+}
+
+#endif
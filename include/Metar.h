@@ -10,8 +10,13 @@
 #include "defines.h"
 
 #ifndef NO_STD
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
+#else
+#include <stddef.h>
+#include <stdint.h>
 #endif
 
 #ifndef NO_PHENOM
@@ -26,6 +31,21 @@ namespace Storage_B
 {
   namespace Weather
   {
+    struct MetarRecord;
+
+#ifndef NO_STD
+    class Arena;
+#endif
+
+    //
+    // A report in a caller owned buffer, need not be NUL terminated
+    //
+    struct MetarText
+    {
+      const char *str;
+      size_t len;
+    };
+
     class Metar
     {
     public:
@@ -52,6 +72,22 @@ namespace Storage_B
         Metar *  // caller is responsible for deleting
 #endif
           Create(char *metar_str);
+
+      //
+      // Static Creator
+      //    metar_str - METAR to decode, need not be NUL terminated
+      //    len       - length of metar_str
+      //
+      //    metar_str is neither modified nor copied, so it may point into
+      //    a read-only buffer such as a memory mapped file.
+      //
+      static
+#ifndef NO_STD
+        std::shared_ptr<Metar>
+#else
+        Metar *  // caller is responsible for deleting
+#endif
+          Create(const char *metar_str, size_t len);
       
       enum class message_type
       {
@@ -75,6 +111,148 @@ namespace Storage_B
         SM  // statute miles
       };
 
+      //
+      // Group matching strategy
+      //    SEQUENTIAL - try every group predicate in turn
+      //    GRAMMAR    - try the groups that may legally follow the last
+      //                 one first, falling back to the others for out of
+      //                 order reports; decodes as SEQUENTIAL does
+      //
+      enum class parse_mode
+      {
+        SEQUENTIAL,
+        GRAMMAR
+      };
+
+      //
+      // Decode options, may be or'ed together
+      //    NORMALIZE - also fill the SI fields of MetarRecord while
+      //                parsing (wind in cm/s, visibility in meters,
+      //                pressure in tenths of hPa, temperatures in tenths
+      //                of a degree C)
+      //    Options are 32 bits wide, int is only 16 bits on AVR.
+      //
+      enum decode_options : uint32_t
+      {
+        DEFAULT = 0,
+        NORMALIZE = 1UL << 0
+      };
+
+      //
+      // Projection, or'ed into the decode options: only the groups of
+      // the fields given are decoded, the others are classified and
+      // skipped.  With no field given every field is decoded.  Remarks
+      // are not scanned at all unless a remark field is given.
+      //    CLOUDS   - cloud layers and vertical visibility
+      //    PRESSURE - altimeter, A or Q group
+      //
+      enum decode_fields : uint32_t
+      {
+        MESSAGE_TYPE = 1UL << 8,
+        STATION = 1UL << 9,
+        TIME = 1UL << 10,
+        WIND = 1UL << 11,
+        VISIBILITY = 1UL << 12,
+        CLOUDS = 1UL << 13,
+        PHENOMENA = 1UL << 14,
+        TEMPERATURE = 1UL << 15,
+        PRESSURE = 1UL << 16,
+        SEA_LEVEL_PRESSURE = 1UL << 17,
+        TEMPERATURE_NA = 1UL << 18,
+
+        REMARKS = SEA_LEVEL_PRESSURE | TEMPERATURE_NA,
+        ALL_FIELDS = (1UL << 19) - (1UL << 8)
+      };
+
+      static_assert(static_cast<uint32_t>(ALL_FIELDS)
+                        == (1UL << 19) - (1UL << 8),
+                    "decode_fields must fit the options type");
+
+      //
+      // Static Creator
+      //    metar_str       - METAR to decode, need not be NUL terminated
+      //    len             - length of metar_str
+      //    mode            - group matching strategy
+      //    predicate_calls - if not null, receives the number of group
+      //                      predicates evaluated (for profiling)
+      //
+      static
+#ifndef NO_STD
+        std::shared_ptr<Metar>
+#else
+        Metar *  // caller is responsible for deleting
+#endif
+          Create(const char *metar_str, size_t len, parse_mode mode,
+                 unsigned int *predicate_calls = nullptr);
+
+#ifndef NO_STD
+      //
+      // Static Creator, for decoding many reports with few allocations
+      //    metar_str - METAR to decode, need not be NUL terminated
+      //    len       - length of metar_str
+      //    arena     - holds the report and its cloud layers and weather
+      //                phenomena; kept alive by the result
+      //    mode      - group matching strategy
+      //
+      //    Arena::Release() must not be called while results are held.
+      //
+      static std::shared_ptr<Metar>
+          Create(const char *metar_str, size_t len,
+                 const std::shared_ptr<Arena>& arena,
+                 parse_mode mode = parse_mode::SEQUENTIAL);
+#endif
+
+#ifndef NO_STD
+      //
+      // Static Creator, for reports whose details are rarely read
+      //    metar_str - METAR to decode, need not be NUL terminated; copied
+      //    len       - length of metar_str
+      //
+      //    Only the main body is decoded here.  Cloud layers, vertical
+      //    visibility and weather phenomena, and separately the remarks,
+      //    are decoded on the first call to one of their accessors and
+      //    kept.  The accessors return what Create gives, including body
+      //    groups that follow RMK.  The result may be read from several
+      //    threads.
+      //
+      static std::shared_ptr<Metar>
+          CreateLazy(const char *metar_str, size_t len);
+#endif
+
+      //
+      // Decode into caller owned storage without allocating
+      //    metar_str       - METAR to decode, need not be NUL terminated
+      //    len             - length of metar_str
+      //    rec             - receives the decoded report (see MetarRecord.h)
+      //    mode            - group matching strategy
+      //    options         - decode_options and decode_fields
+      //    predicate_calls - if not null, receives the number of group
+      //                      predicates evaluated (for profiling)
+      //
+      //    returns false if no group could be decoded
+      //
+      static bool Decode(const char *metar_str, size_t len, MetarRecord& rec,
+                         parse_mode mode = parse_mode::SEQUENTIAL,
+                         uint32_t options = DEFAULT,
+                         unsigned int *predicate_calls = nullptr);
+
+      //
+      // Decode a batch of reports into contiguous caller owned storage
+      //    reports - reports to decode
+      //    n       - number of reports
+      //    out     - receives n records, out[i] is decoded from reports[i]
+      //    ok      - if not null, receives n flags, false if the report
+      //              could not be decoded
+      //    mode    - group matching strategy
+      //    options - decode_options and decode_fields
+      //
+      //    returns the number of reports decoded
+      //
+      static size_t DecodeBatch(const MetarText *reports, size_t n,
+                                MetarRecord *out, bool *ok = nullptr,
+                                parse_mode mode = parse_mode::SEQUENTIAL,
+                                uint32_t options = DEFAULT);
+
       Metar() = default;
 
       virtual ~Metar() = default;
@@ -83,6 +261,11 @@ namespace Storage_B
       Metar(const Metar&) = delete;
       Metar& operator=(const Metar&) = delete;
 
+      //
+      // Decoded report as a plain value
+      //
+      virtual const MetarRecord& Record() const = 0;
+
       //
       // Message type: METAR or SPECI
       //
@@ -237,7 +420,10 @@ namespace Storage_B
 
 #ifndef NO_CLOUDS
       //
-      // Number of Cloud Layers
+      // Number of Cloud Layers.  Every layer reported is kept; NO_STD
+      // builds keep only the first MetarRecord::MAX_CLOUD_LAYERS.
+      // Record() holds the first ones either way and sets truncated if
+      // more were reported
       //
       virtual unsigned int NumCloudLayers() const = 0;
 
@@ -248,9 +434,19 @@ namespace Storage_B
         const Clouds *
 #endif
           Layer(unsigned int idx) const = 0;
+
+      //
+      // The NumCloudLayers() layers as plain values, stored in the
+      // report, so reading them involves no reference counting
+      //
+      virtual const CloudLayer *CloudLayers() const = 0;
 #endif
 
 #ifndef NO_PHENOM
+      //
+      // Number of weather phenomena groups, every group reported as for
+      // NumCloudLayers(), with MetarRecord::MAX_PHENOMENA the NO_STD cap
+      //
       virtual unsigned int NumPhenomena() const = 0;
 
       virtual const Phenom& Phenomenon(unsigned int idx) const = 0;
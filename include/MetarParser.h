@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Long lived METAR decoder that reuses its storage from report to report
+//
+
+#ifndef STORAGE_B_WEATHER_METAR_PARSER_H_
+#define STORAGE_B_WEATHER_METAR_PARSER_H_
+
+#include "defines.h"
+
+#ifndef NO_STD
+
+#include "Metar.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace Storage_B
+{
+  namespace Weather
+  {
+    //
+    // Decodes a stream of reports into one Metar owned by the parser.
+    // The report, its cloud layers and its weather phenomena live in
+    // storage allocated once, so after the first report decoding does no
+    // heap allocation.  Not thread safe; use one parser per thread.
+    //
+    class MetarParser
+    {
+    public:
+      //
+      // Static Creator
+      //
+      static std::shared_ptr<MetarParser> Create();
+
+      virtual ~MetarParser() = default;
+
+      MetarParser(const MetarParser&) = delete;
+      MetarParser& operator=(const MetarParser&) = delete;
+
+      //
+      // Decode a report, replacing the current one
+      //    metar_str - METAR to decode, need not be NUL terminated
+      //    len       - length of metar_str
+      //    mode      - group matching strategy
+      //    options   - Metar::decode_options and Metar::decode_fields
+      //
+      //    returns false if no group could be decoded
+      //
+      virtual bool Parse(const char *metar_str, size_t len,
+                         Metar::parse_mode mode =
+                             Metar::parse_mode::SEQUENTIAL,
+                         uint32_t options = Metar::DEFAULT) = 0;
+
+      //
+      // Drop the current report, Report() then has no fields
+      //
+      virtual void Reset() = 0;
+
+      //
+      // The current report, only valid until the next Parse() or
+      // Reset().  Its Layer() handles are copies that stay valid, and
+      // each takes an allocation; CloudLayers() reads the layers in
+      // place.
+      //
+      virtual const Metar& Report() const = 0;
+
+    protected:
+      MetarParser() = default;
+    };
+  }
+}
+
+#endif
+
+#endif
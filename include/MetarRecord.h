@@ -0,0 +1,215 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Decoded METAR as a plain value
+//
+
+#ifndef STORAGE_B_WEATHER_METAR_RECORD_H_
+#define STORAGE_B_WEATHER_METAR_RECORD_H_
+
+#include "Metar.h"
+
+#ifndef NO_STD
+#include <climits>
+#include <cfloat>
+#include <type_traits>
+#else
+#include <limits.h>
+#include <float.h>
+#endif
+
+namespace Storage_B
+{
+  namespace Weather
+  {
+    //
+    // Fixed size, heap free, trivially copyable form of a decoded METAR.
+    // Filled by Metar::Decode() into caller owned storage, so reports can
+    // be kept in flat arrays.  Fields that were not reported hold
+    // INTEGER_UNDEFINED or DOUBLE_UNDEFINED, the has...() members mirror
+    // the Metar interface.
+    //
+    // Fractional values are stored as scaled integers; the accessors of
+    // the same name as the Metar interface return them as doubles
+    // (DOUBLE_UNDEFINED if not reported).
+    //
+    struct MetarRecord
+    {
+      static constexpr int INTEGER_UNDEFINED = INT_MIN;
+      static constexpr double DOUBLE_UNDEFINED = DBL_MAX;
+
+#ifndef NO_CLOUDS
+      static const unsigned int MAX_CLOUD_LAYERS = 6;
+#endif
+#ifndef NO_PHENOM
+      static const unsigned int MAX_PHENOMENA = 16;
+#endif
+
+      // visibility in statute miles is stored in sixteenths
+      static const int VIS_SM_SCALE = 16;
+
+      MetarRecord() { Clear(); }
+
+      void Clear();
+
+      double Visibility() const
+      {
+        if (!hasVisibility()) return DOUBLE_UNDEFINED;
+        return (vis_units == Metar::distance_units::SM)
+            ? static_cast<double>(vis) / VIS_SM_SCALE : vis;
+      }
+
+      double AltimeterA() const { return scaled(altimeterA, 100.0); }
+      double SeaLevelPressure() const { return scaled(slp, 10.0); }
+      double TemperatureNA() const { return scaled(ftemp, 10.0); }
+      double DewPointNA() const { return scaled(fdew, 10.0); }
+
+      double WindSpeedSI() const { return scaled(wind_spd_cms, 100.0); }
+      double WindGustSI() const { return scaled(gust_cms, 100.0); }
+      double VisibilitySI() const { return scaled(vis_m, 1.0); }
+      double PressureSI() const { return scaled(pressure_dhpa, 10.0); }
+      double TemperatureSI() const { return scaled(temp_dc, 10.0); }
+      double DewPointSI() const { return scaled(dew_dc, 10.0); }
+
+      bool hasMessageType() const
+      {
+        return message_type != Metar::message_type::undefined;
+      }
+
+      bool hasICAO() const { return icao[0] != '\0'; }
+
+      bool hasDay() const { return day != INTEGER_UNDEFINED; }
+      bool hasHour() const { return hour != INTEGER_UNDEFINED; }
+      bool hasMinute() const { return minute != INTEGER_UNDEFINED; }
+
+      bool hasWindDirection() const
+      {
+        return wind_dir != INTEGER_UNDEFINED;
+      }
+      bool hasWindSpeed() const { return wind_spd != INTEGER_UNDEFINED; }
+      bool hasWindGust() const { return gust != INTEGER_UNDEFINED; }
+      bool hasMinWindDirection() const
+      {
+        return min_wind_dir != INTEGER_UNDEFINED;
+      }
+      bool hasMaxWindDirection() const
+      {
+        return max_wind_dir != INTEGER_UNDEFINED;
+      }
+      bool hasWindSpeedUnits() const
+      {
+        return wind_speed_units != Metar::speed_units::undefined;
+      }
+
+      bool hasVisibility() const { return vis != INTEGER_UNDEFINED; }
+      bool hasVisibilityUnits() const
+      {
+        return vis_units != Metar::distance_units::undefined;
+      }
+
+      bool hasVerticalVisibility() const
+      {
+        return vert_vis != INTEGER_UNDEFINED;
+      }
+
+      bool hasTemperature() const { return temp != INTEGER_UNDEFINED; }
+      bool hasDewPoint() const { return dew != INTEGER_UNDEFINED; }
+
+      bool hasAltimeterA() const { return altimeterA != INTEGER_UNDEFINED; }
+      bool hasAltimeterQ() const { return altimeterQ != INTEGER_UNDEFINED; }
+
+      bool hasSeaLevelPressure() const { return slp != INTEGER_UNDEFINED; }
+
+      bool hasTemperatureNA() const { return ftemp != INTEGER_UNDEFINED; }
+      bool hasDewPointNA() const { return fdew != INTEGER_UNDEFINED; }
+
+      bool hasWindSpeedSI() const
+      {
+        return wind_spd_cms != INTEGER_UNDEFINED;
+      }
+      bool hasWindGustSI() const { return gust_cms != INTEGER_UNDEFINED; }
+      bool hasVisibilitySI() const { return vis_m != INTEGER_UNDEFINED; }
+      bool hasPressureSI() const
+      {
+        return pressure_dhpa != INTEGER_UNDEFINED;
+      }
+      bool hasTemperatureSI() const { return temp_dc != INTEGER_UNDEFINED; }
+      bool hasDewPointSI() const { return dew_dc != INTEGER_UNDEFINED; }
+
+      Metar::message_type message_type;
+
+      char icao[5];
+
+      int day;
+      int hour;
+      int minute;
+
+      int wind_dir;
+      int wind_spd;
+      int gust;
+      Metar::speed_units wind_speed_units;
+
+      int min_wind_dir;
+      int max_wind_dir;
+      bool vrb;
+
+      int vis;             // meters, or 1/16 SM (see VIS_SM_SCALE)
+      Metar::distance_units vis_units;
+      bool vis_lt;
+      bool cavok;
+
+      int vert_vis;
+
+      int temp;
+      int dew;
+
+      int altimeterA;      // hundredths of inHg
+      int altimeterQ;      // hPa
+
+      int slp;             // tenths of hPa
+
+      int ftemp;           // tenths of a degree C, from the T remark group
+      int fdew;
+
+      //
+      // Filled only when decoding with Metar::NORMALIZE, scaled like the
+      // fields above; the ...SI() accessors return them as doubles
+      //
+      int wind_spd_cms;    // cm/s
+      int gust_cms;
+      int vis_m;           // meters, 10000 for CAVOK
+      int pressure_dhpa;   // tenths of hPa, Q group, else A group converted
+      int temp_dc;         // tenths of a degree C, T remark group first
+      int dew_dc;
+
+      //
+      // More cloud layers than MAX_CLOUD_LAYERS or weather groups than
+      // MAX_PHENOMENA were reported; the first ones were kept
+      //
+      bool truncated;
+
+#ifndef NO_CLOUDS
+      unsigned int num_layers;
+      CloudLayer layers[MAX_CLOUD_LAYERS];
+#endif
+
+#ifndef NO_PHENOM
+      unsigned int num_phenomena;
+      PhenomGroup phenomena[MAX_PHENOMENA];
+#endif
+
+    private:
+      static double scaled(int value, double scale)
+      {
+        return (value != INTEGER_UNDEFINED) ? value / scale : DOUBLE_UNDEFINED;
+      }
+    };
+
+#ifndef NO_STD
+    static_assert(std::is_trivially_copyable<MetarRecord>::value,
+                  "MetarRecord must be trivially copyable");
+#endif
+  }
+}
+
+#endif
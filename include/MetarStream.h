@@ -0,0 +1,227 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Push decoder for reports arriving in arbitrary chunks, one per line
+//
+
+#ifndef STORAGE_B_WEATHER_METAR_STREAM_H_
+#define STORAGE_B_WEATHER_METAR_STREAM_H_
+
+#include "Metar.h"
+#include "MetarRecord.h"
+
+#ifndef NO_STD
+#include <cstddef>
+#include <cstring>
+#else
+#include <stddef.h>
+#include <string.h>
+#endif
+
+namespace Storage_B
+{
+  namespace Weather
+  {
+    //
+    // Collects bytes into a caller owned line buffer and decodes each
+    // line as its '\n' arrives, so a report may be split anywhere, even
+    // inside a group, across Push() calls.  Memory use is the line
+    // buffer and one MetarRecord however long the input: the caller's,
+    // or else a temporary one while a line is decoded.  Empty lines and
+    // a trailing '\r' are dropped.  A line longer than the buffer is cut
+    // back to its last whole group and the rest ignored.
+    //
+    // The handler is called as
+    //    handler(const char *line, size_t len, const MetarRecord& rec,
+    //            bool ok)
+    // with the NUL terminated line and its record; the line is only
+    // valid for the duration of the call, and so is the record unless it
+    // is the caller's.  ok is false if the line could not be decoded.
+    //
+    class MetarStream
+    {
+    public:
+      //
+      //    buffer  - line storage, must outlive the stream
+      //    size    - length of buffer, the longest line kept is size - 1
+      //    mode    - group matching strategy
+      //    options - Metar::decode_options and Metar::decode_fields
+      //
+      MetarStream(char *buffer, size_t size,
+                  Metar::parse_mode mode = Metar::parse_mode::SEQUENTIAL,
+                  uint32_t options = Metar::DEFAULT)
+        : _buffer(buffer), _size(size), _mode(mode), _options(options)
+      {
+      }
+
+      MetarStream(const MetarStream&) = delete;
+      MetarStream& operator=(const MetarStream&) = delete;
+      ~MetarStream() = default;
+
+      //
+      // Consume a chunk of input
+      //    data    - bytes received, need not end on a line or group
+      //    len     - length of data
+      //    handler - called for every line completed by this chunk
+      //
+      //    returns the number of lines decoded
+      //
+      template <typename Handler>
+      size_t Push(const char *data, size_t len, Handler&& handler)
+      {
+        return push(data, len, nullptr, handler);
+      }
+
+      //
+      // As above, decoding each line into rec
+      //
+      template <typename Handler>
+      size_t Push(const char *data, size_t len, MetarRecord& rec,
+                  Handler&& handler)
+      {
+        return push(data, len, &rec, handler);
+      }
+
+      //
+      // End of input: decode a final line that has no '\n'
+      //
+      //    returns the number of lines decoded, 0 or 1
+      //
+      template <typename Handler>
+      size_t Finish(Handler&& handler)
+      {
+        return emit(nullptr, handler);
+      }
+
+      //
+      // As above, decoding the line into rec
+      //
+      template <typename Handler>
+      size_t Finish(MetarRecord& rec, Handler&& handler)
+      {
+        return emit(&rec, handler);
+      }
+
+      //
+      // Drop a partially received line
+      //
+      void Reset()
+      {
+        _len = 0;
+        _truncated = false;
+        _split_group = false;
+      }
+
+      //
+      // Bytes of the current line held so far
+      //
+      size_t Pending() const { return _len; }
+
+    private:
+      template <typename Handler>
+      size_t push(const char *data, size_t len, MetarRecord *rec,
+                  Handler& handler)
+      {
+        size_t lines = 0;
+
+        while (len)
+        {
+          const char *eol =
+              static_cast<const char *>(memchr(data, '\n', len));
+          size_t n = eol ? static_cast<size_t>(eol - data) : len;
+
+          append(data, n);
+          if (!eol)
+          {
+            break;
+          }
+
+          lines += emit(rec, handler);
+
+          data += n + 1;
+          len -= n + 1;
+        }
+
+        return lines;
+      }
+
+      void append(const char *data, size_t n)
+      {
+        size_t room = _size ? _size - 1 - _len : 0;
+        if (n > room)
+        {
+          // a cut just before a separator keeps the last group whole
+          if (!_truncated)
+          {
+            _split_group = data[room] != ' ' && data[room] != '\r';
+          }
+
+          n = room;
+          _truncated = true;
+        }
+
+        memcpy(_buffer + _len, data, n);
+        _len += n;
+      }
+
+      template <typename Handler>
+      size_t emit(MetarRecord *rec, Handler& handler)
+      {
+        size_t len = _len;
+
+        if (_split_group)
+        {
+          while (len && _buffer[len - 1] != ' ')
+          {
+            len--;
+          }
+        }
+
+        while (len && (_buffer[len - 1] == '\r' || _buffer[len - 1] == ' '))
+        {
+          len--;
+        }
+
+        Reset();
+
+        if (!len)
+        {
+          return 0;
+        }
+
+        _buffer[len] = '\0';
+
+        if (rec)
+        {
+          decode(len, *rec, handler);
+        }
+        else
+        {
+          MetarRecord line_rec;
+          decode(len, line_rec, handler);
+        }
+
+        return 1;
+      }
+
+      template <typename Handler>
+      void decode(size_t len, MetarRecord& rec, Handler& handler)
+      {
+        bool ok = Metar::Decode(_buffer, len, rec, _mode, _options);
+        handler(static_cast<const char *>(_buffer), len,
+                static_cast<const MetarRecord&>(rec), ok);
+      }
+
+      char *_buffer;
+      size_t _size;
+      size_t _len = 0;
+      bool _truncated = false;
+      bool _split_group = false;
+
+      Metar::parse_mode _mode;
+      uint32_t _options;
+    };
+  }
+}
+
+#endif
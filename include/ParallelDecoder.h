@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Multi-threaded decoder for buffers holding one METAR per line
+//
+
+#ifndef STORAGE_B_WEATHER_PARALLEL_DECODER_H_
+#define STORAGE_B_WEATHER_PARALLEL_DECODER_H_
+
+#include "defines.h"
+
+#ifndef NO_STD
+
+#include "Metar.h"
+#include "MetarRecord.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Storage_B
+{
+  namespace Weather
+  {
+    class ParallelDecoder
+    {
+    public:
+      static const size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+      //
+      // Static Creator
+      //    num_threads - worker threads including the calling thread,
+      //                  0 for one per hardware thread
+      //    chunk_size  - approximate number of bytes handed to a worker
+      //                  at a time (split at line boundaries)
+      //
+      static std::shared_ptr<ParallelDecoder>
+          Create(unsigned int num_threads = 0,
+                 size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+      virtual ~ParallelDecoder() = default;
+
+      ParallelDecoder(const ParallelDecoder&) = delete;
+      ParallelDecoder& operator=(const ParallelDecoder&) = delete;
+
+      //
+      // Decode every non-empty line of buffer
+      //    buffer  - reports separated by '\n' (a trailing '\r' is
+      //              ignored), need not be NUL terminated
+      //    len     - length of buffer
+      //    out     - replaced by one record per line, in input order
+      //    ok      - if not null, replaced by one flag per line, false if
+      //              the line could not be decoded
+      //    mode    - group matching strategy
+      //    options - Metar::decode_options and Metar::decode_fields
+      //
+      //    returns the number of lines decoded
+      //
+      //    May be called from several threads at once, the calls share
+      //    the worker threads in turn.
+      //
+      virtual size_t Decode(const char *buffer, size_t len,
+                            std::vector<MetarRecord>& out,
+                            std::vector<bool> *ok = nullptr,
+                            Metar::parse_mode mode =
+                                Metar::parse_mode::SEQUENTIAL,
+                            uint32_t options = Metar::DEFAULT) = 0;
+
+      virtual unsigned int NumThreads() const = 0;
+
+    protected:
+      ParallelDecoder() = default;
+    };
+  }
+}
+
+#endif
+
+#endif
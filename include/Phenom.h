@@ -10,14 +10,25 @@
 #include "defines.h"
 
 #ifndef NO_STD
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
+#else
+#include <stddef.h>
+#include <stdint.h>
 #endif
 
 namespace Storage_B
 {
   namespace Weather
   {
+    struct PhenomGroup;
+
+#ifndef NO_STD
+    class Arena;
+#endif
+
     class Phenom
     {
     public:
@@ -64,6 +75,67 @@ namespace Storage_B
 #endif
               Create(const char *str, bool temp = false);
 
+      //
+      // As above, str need not be NUL terminated
+      //
+      static
+#ifndef NO_STD
+          std::shared_ptr<Phenom>
+#else
+          Phenom *
+#endif
+              Create(const char *str, size_t len, bool temp = false);
+
+      //
+      // Static Creator
+      //    group - decoded weather phenomena group
+      //
+      static
+#ifndef NO_STD
+          std::shared_ptr<Phenom>
+#else
+          Phenom *
+#endif
+              Create(const PhenomGroup& group);
+
+#ifndef NO_STD
+      //
+      // Static Creator
+      //    group - decoded weather phenomena group
+      //    arena - owns the result, which lives until the arena is
+      //            released
+      //
+      static Phenom *Create(const PhenomGroup& group, Arena& arena);
+
+      //
+      // Arena space one Create(group, arena) takes at most
+      //
+      static size_t ArenaSize();
+#endif
+
+      //
+      // Decode a weather phenomena group without allocating
+      //    returns false if str is not a weather phenomena group
+      //
+      static bool Decode(const char *str, size_t len, bool temp,
+                         PhenomGroup& group);
+
+      //
+      // Scan a column of groups
+      //    groups      - groups to scan
+      //    n           - number of groups
+      //    phenoms     - PhenomGroup::Mask() bits, a group must report at
+      //                  least one of them (0 to ignore)
+      //    descriptors - PhenomGroup descriptor bits, a group must report
+      //                  all of them
+      //    match       - if not null, receives n flags
+      //
+      //    returns the number of matching groups
+      //
+      static size_t Match(const PhenomGroup *groups, size_t n,
+                          uint32_t phenoms, uint32_t descriptors,
+                          bool *match = nullptr);
+
       virtual ~Phenom() = default;
 
       virtual unsigned int NumPhenom() const = 0;
@@ -87,6 +159,119 @@ namespace Storage_B
       virtual bool ThunderStorm() const = 0;
       virtual bool Temporary() const = 0;
     };
+
+    //
+    // Plain value form of a weather phenomena group, packed into 8 bytes
+    // so columns of groups can be queried with bitwise operations
+    //
+    struct PhenomGroup
+    {
+      //
+      // Descriptor bits
+      //
+      enum : uint32_t
+      {
+        VICINITY     = 1 << 0,  // VC
+        BLOWING      = 1 << 1,  // BL
+        DRIFTING     = 1 << 2,  // DR
+        FREEZING     = 1 << 3,  // FZ
+        PARTIAL      = 1 << 4,  // PR
+        SHALLOW      = 1 << 5,  // MI
+        PATCHES      = 1 << 6,  // BC
+        THUNDERSTORM = 1 << 7,  // TS
+        TEMPORARY    = 1 << 8   // reported after TEMPO
+      };
+
+      //
+      // Phenomena whose report order is kept, see At()
+      //
+      static const unsigned int ORDERED = 4;
+
+      //
+      // Bit of each phenomenon.  NONE is never reported, so its bit is
+      // given to SHOWER.
+      //
+      static constexpr uint32_t Mask(Phenom::phenom p)
+      {
+        return p == Phenom::phenom::SHOWER
+            ? 1 : uint32_t(1) << static_cast<int>(p);
+      }
+
+      // DZ RA SN SG IC PE GR GS UP
+      static constexpr uint32_t PRECIPITATION =
+          (uint32_t(1) << static_cast<int>(Phenom::phenom::DRIZZLE))
+        | (uint32_t(1) << static_cast<int>(Phenom::phenom::RAIN))
+        | (uint32_t(1) << static_cast<int>(Phenom::phenom::SNOW))
+        | (uint32_t(1) << static_cast<int>(Phenom::phenom::SNOW_GRAINS))
+        | (uint32_t(1) << static_cast<int>(Phenom::phenom::ICE_CRYSTALS))
+        | (uint32_t(1) << static_cast<int>(Phenom::phenom::ICE_PELLETS))
+        | (uint32_t(1) << static_cast<int>(Phenom::phenom::HAIL))
+        | (uint32_t(1) << static_cast<int>(Phenom::phenom::SMALL_HAIL))
+        | (uint32_t(1) << static_cast<int>(Phenom::phenom::UNKNOWN_PRECIP));
+
+      bool Has(Phenom::phenom p) const { return (phenoms & Mask(p)) != 0; }
+
+      Phenom::intensity Intensity() const
+      {
+        return static_cast<Phenom::intensity>(static_cast<int>(intensity) - 1);
+      }
+
+      unsigned int NumPhenom() const
+      {
+        return __builtin_popcountl(phenoms);
+      }
+
+      //
+      // idx'th phenomenon in report order, which gives predominance
+      // (-SNRA is mainly snow).  The first ORDERED distinct phenomena
+      // keep their order, any beyond follow in Mask() bit order.
+      //    returns NONE if idx is out of range
+      //
+      Phenom::phenom At(unsigned int idx) const
+      {
+        unsigned int n = NumPhenom();
+        if (idx >= n)
+        {
+          return Phenom::phenom::NONE;
+        }
+
+        unsigned int ordered = n < ORDERED ? n : ORDERED;
+        if (idx < ordered)
+        {
+          return static_cast<Phenom::phenom>((order >> (5 * idx)) & 0x1F);
+        }
+
+        uint32_t m = phenoms;
+        for (unsigned int i = 0 ; i < ordered ; i++)
+        {
+          m &= ~Mask(static_cast<Phenom::phenom>((order >> (5 * i)) & 0x1F));
+        }
+        for (idx -= ordered ; idx ; idx--)
+        {
+          m &= m - 1;
+        }
+
+        // bit 0 is SHOWER, see Mask()
+        int bit = __builtin_ctzl(m);
+        return bit ? static_cast<Phenom::phenom>(bit)
+                   : Phenom::phenom::SHOWER;
+      }
+
+      //
+      // At least one of phenoms (if any) and all of descriptors
+      //
+      bool Matches(uint32_t any_phenoms, uint32_t all_descriptors) const
+      {
+        return (!any_phenoms || (phenoms & any_phenoms))
+            && ((descriptors & all_descriptors) == all_descriptors);
+      }
+
+      uint32_t phenoms;          // Mask() of each phenomenon reported
+      uint32_t descriptors : 9;
+      uint32_t intensity : 2;    // Phenom::intensity + 1
+      uint32_t order : 5 * ORDERED;  // Phenom::phenom of the first
+                                     // ORDERED, 5 bits each
+    };
   }
 }
 
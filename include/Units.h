@@ -0,0 +1,328 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Unit typed quantities with conversions resolved at compile time
+//
+
+#ifndef STORAGE_B_WEATHER_UNITS_H_
+#define STORAGE_B_WEATHER_UNITS_H_
+
+#include "Metar.h"
+
+#ifndef NO_STD
+#include <cstddef>
+#else
+#include <stddef.h>
+#endif
+
+namespace Storage_B
+{
+  namespace Weather
+  {
+    struct SpeedDimension {};
+    struct DistanceDimension {};
+    struct PressureDimension {};
+    struct TemperatureDimension {};
+
+    //
+    // Units: a value in the unit is (value in the base unit of its
+    // dimension * PER_BASE) + OFFSET.  The factors are the ones used by
+    // Convert.
+    //
+    struct Knots
+    {
+      typedef SpeedDimension dimension;
+      static constexpr double PER_BASE = 1.0;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct MetersPerSecond
+    {
+      typedef SpeedDimension dimension;
+      static constexpr double PER_BASE = 0.514444;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct KilometersPerHour
+    {
+      typedef SpeedDimension dimension;
+      static constexpr double PER_BASE = 1.852;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct MilesPerHour
+    {
+      typedef SpeedDimension dimension;
+      static constexpr double PER_BASE = 1.15078;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct Meters
+    {
+      typedef DistanceDimension dimension;
+      static constexpr double PER_BASE = 1.0;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct Feet
+    {
+      typedef DistanceDimension dimension;
+      static constexpr double PER_BASE = 3.28084;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct Kilometers
+    {
+      typedef DistanceDimension dimension;
+      static constexpr double PER_BASE = 0.001;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct StatuteMiles
+    {
+      typedef DistanceDimension dimension;
+      static constexpr double PER_BASE = 1.0 / 1609.34;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct NauticalMiles
+    {
+      typedef DistanceDimension dimension;
+      static constexpr double PER_BASE = 1.0 / 1852.0;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct HectoPascal
+    {
+      typedef PressureDimension dimension;
+      static constexpr double PER_BASE = 1.0;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct InchesOfMercury
+    {
+      typedef PressureDimension dimension;
+      static constexpr double PER_BASE = 0.02953;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct Celsius
+    {
+      typedef TemperatureDimension dimension;
+      static constexpr double PER_BASE = 1.0;
+      static constexpr double OFFSET = 0.0;
+    };
+
+    struct Fahrenheit
+    {
+      typedef TemperatureDimension dimension;
+      static constexpr double PER_BASE = 1.8;
+      static constexpr double OFFSET = 32.0;
+    };
+
+    //
+    // Conversion between two units of the same dimension, folded to a
+    // multiply (plus an add for temperatures) at compile time
+    //
+    template <typename From, typename To>
+    struct UnitConversion
+    {
+      template <typename A, typename B>
+      struct same { static const bool value = false; };
+      template <typename A>
+      struct same<A, A> { static const bool value = true; };
+
+      static_assert(same<typename From::dimension,
+                         typename To::dimension>::value,
+                    "units measure different quantities");
+
+      static constexpr double SCALE = To::PER_BASE / From::PER_BASE;
+      static constexpr double OFFSET = To::OFFSET - (From::OFFSET * SCALE);
+
+      static constexpr double Apply(double value)
+      {
+        return (OFFSET == 0.0) ? value * SCALE : (value * SCALE) + OFFSET;
+      }
+    };
+
+    //
+    // A double tagged with its unit.  Converting to another unit of the
+    // same dimension is implicit, mixing dimensions does not compile.
+    //
+    template <typename Unit>
+    class Quantity
+    {
+    public:
+      typedef Unit unit;
+
+      constexpr Quantity() : _value(0.0) {}
+      constexpr explicit Quantity(double value) : _value(value) {}
+
+      template <typename From>
+      constexpr Quantity(const Quantity<From>& q)
+        : _value(UnitConversion<From, Unit>::Apply(q.Value()))
+      {
+      }
+
+      constexpr double Value() const { return _value; }
+
+      template <typename To>
+      constexpr Quantity<To> As() const { return Quantity<To>(*this); }
+
+      constexpr Quantity operator+(Quantity q) const
+      {
+        return Quantity(_value + q._value);
+      }
+      constexpr Quantity operator-(Quantity q) const
+      {
+        return Quantity(_value - q._value);
+      }
+      constexpr Quantity operator*(double d) const
+      {
+        return Quantity(_value * d);
+      }
+      constexpr Quantity operator/(double d) const
+      {
+        return Quantity(_value / d);
+      }
+
+      constexpr bool operator==(Quantity q) const { return _value == q._value; }
+      constexpr bool operator!=(Quantity q) const { return _value != q._value; }
+      constexpr bool operator<(Quantity q) const { return _value < q._value; }
+      constexpr bool operator>(Quantity q) const { return _value > q._value; }
+      constexpr bool operator<=(Quantity q) const { return _value <= q._value; }
+      constexpr bool operator>=(Quantity q) const { return _value >= q._value; }
+
+    private:
+      double _value;
+    };
+
+    //
+    // Quantity restricted to the units of one dimension, e.g.
+    // Speed<Knots>.  Speed<Meters> does not compile.
+    //
+    template <typename Dimension, typename Unit,
+              typename = typename Unit::dimension>
+    struct DimensionOf;
+
+    template <typename Dimension, typename Unit>
+    struct DimensionOf<Dimension, Unit, Dimension>
+    {
+      typedef Quantity<Unit> type;
+    };
+
+    template <typename Unit>
+    using Speed = typename DimensionOf<SpeedDimension, Unit>::type;
+
+    template <typename Unit>
+    using Distance = typename DimensionOf<DistanceDimension, Unit>::type;
+
+    template <typename Unit>
+    using Pressure = typename DimensionOf<PressureDimension, Unit>::type;
+
+    template <typename Unit>
+    using Temperature = typename DimensionOf<TemperatureDimension, Unit>::type;
+
+    class Units
+    {
+    public:
+      //
+      // Convert n values from one unit to another, out may alias in.
+      // The loop body is a single multiply (a multiply and an add for
+      // temperatures), which the compiler vectorizes.
+      //
+      template <typename From, typename To>
+      static void Convert(const double *in, double *out, size_t n)
+      {
+        for (size_t i = 0 ; i < n ; i++)
+        {
+          out[i] = UnitConversion<From, To>::Apply(in[i]);
+        }
+      }
+
+      template <typename From, typename To>
+      static void Convert(const Quantity<From> *in, Quantity<To> *out,
+                          size_t n)
+      {
+        for (size_t i = 0 ; i < n ; i++)
+        {
+          out[i] = in[i];
+        }
+      }
+
+      //
+      // Factor converting a reported speed or distance to unit To,
+      // 1.0 if the reported units are undefined
+      //
+      template <typename To>
+      static double Scale(Metar::speed_units from)
+      {
+        switch (from)
+        {
+          case Metar::speed_units::KT:
+            return UnitConversion<Knots, To>::SCALE;
+
+          case Metar::speed_units::MPS:
+            return UnitConversion<MetersPerSecond, To>::SCALE;
+
+          case Metar::speed_units::KPH:
+            return UnitConversion<KilometersPerHour, To>::SCALE;
+
+          default:
+            return 1.0;
+        }
+      }
+
+      template <typename To>
+      static double Scale(Metar::distance_units from)
+      {
+        switch (from)
+        {
+          case Metar::distance_units::M:
+            return UnitConversion<Meters, To>::SCALE;
+
+          case Metar::distance_units::SM:
+            return UnitConversion<StatuteMiles, To>::SCALE;
+
+          default:
+            return 1.0;
+        }
+      }
+
+      template <typename To>
+      static Speed<To> ToSpeed(double value, Metar::speed_units from)
+      {
+        return Speed<To>(value * Scale<To>(from));
+      }
+
+      template <typename To>
+      static Distance<To> ToDistance(double value,
+                                     Metar::distance_units from)
+      {
+        return Distance<To>(value * Scale<To>(from));
+      }
+
+      //
+      // Normalize a column of n values all reported in the same units:
+      // the unit is resolved once, then every element is one multiply
+      //
+      template <typename To, typename FromUnits>
+      static void Normalize(const double *in, FromUnits from, double *out,
+                            size_t n)
+      {
+        const double scale = Scale<To>(from);
+        for (size_t i = 0 ; i < n ; i++)
+        {
+          out[i] = in[i] * scale;
+        }
+      }
+
+      Units() = delete;
+      Units(const Units&) = delete;
+      Units& operator=(const Units&) = delete;
+      ~Units() = default;
+    };
+  }
+}
+
+#endif
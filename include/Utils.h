@@ -9,6 +9,12 @@
 
 #include "defines.h"
 
+#ifndef NO_STD
+#include <cstddef>
+#else
+#include <stddef.h>
+#endif
+
 namespace Storage_B 
 {
   namespace Weather
@@ -21,6 +27,40 @@ namespace Storage_B
       static double HeatIndex(double temp, double humidity,
                               bool celsius_flg = false);
 
+      //
+      // Array versions: out[i] is computed from the i'th element of each
+      // input, for n elements.  out may alias an input.
+      //
+      // Humidity with SSE2 or AVX2, and WindChill and HeatIndex with
+      // AVX2, are vectorised, exp() and pow() being replaced by
+      // polynomial approximations.  Over inputs of -60 to 60 C, 0 to
+      // 200 km/h and 0 to 100 % the largest differences from the scalar
+      // versions are
+      //    Humidity   1e-12 % relative humidity
+      //    WindChill  1e-12 C
+      // HeatIndex needs no approximation and matches exactly.
+      // Otherwise they call the scalar versions.
+      //
+      static void Humidity(const double *t, const double *td, double *out,
+                           size_t n);
+      static void WindChill(const double *temp, const double *wind_speed,
+                            double *out, size_t n);
+      static void HeatIndex(const double *temp, const double *humidity,
+                            double *out, size_t n, bool celsius_flg = false);
+
+      //
+      // Fast approximations for display, using low order minimax
+      // polynomials in place of exp() and pow().  Over -60 to 60 C,
+      // dew points down to -80 C, 0 to 300 km/h and 0 to 100 % the
+      // largest differences from the exact versions are
+      //    HumidityFast   0.01 % relative humidity
+      //    WindChillFast  0.02 C
+      // HeatIndex has no fast version, it is a polynomial already and
+      // only calls sqrt() for very dry air.
+      //
+      static double HumidityFast(double t, double td);
+      static double WindChillFast(double temp, double wind_speed);
+
       Utils() = delete;
       Utils(const Utils&) = delete;
       Utils& operator=(const Utils&) = delete;
@@ -0,0 +1,262 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Memory mapped file holding one METAR per line
+//
+
+#include "Archive.h"
+
+#ifndef NO_STD
+
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+namespace
+{
+  const size_t BLOCK_SIZE = 64;
+
+  //
+  // Bit i set if p[i] is '\n', for the (up to) 64 bytes at p
+  //
+  uint64_t newline_mask(const char *p, const char *end)
+  {
+    uint64_t mask = 0;
+
+#ifdef __SSE2__
+    if (static_cast<size_t>(end - p) >= BLOCK_SIZE)
+    {
+      const __m128i nl = _mm_set1_epi8('\n');
+      for (size_t i = 0 ; i < BLOCK_SIZE ; i += 16)
+      {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        uint64_t m =
+            static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+        mask |= m << i;
+      }
+      return mask;
+    }
+#endif
+
+    size_t n = end - p;
+    if (n > BLOCK_SIZE) n = BLOCK_SIZE;
+    for (size_t i = 0 ; i < n ; i++)
+    {
+      if (p[i] == '\n') mask |= uint64_t(1) << i;
+    }
+    return mask;
+  }
+
+  //
+  // Walks the line boundaries of a buffer 64 bytes at a time, so each
+  // byte is compared against '\n' exactly once
+  //
+  class LineScanner
+  {
+  public:
+    LineScanner(const char *begin, const char *end)
+      : _block(begin)
+      , _end(end)
+      , _line(begin)
+      , _mask(begin < end ? newline_mask(begin, end) : 0)
+    {
+    }
+
+    // line excludes the '\n'
+    bool next(const char *& line, size_t& len);
+
+  private:
+    const char *_block;
+    const char *_end;
+    const char *_line;
+    uint64_t _mask;
+  };
+
+  bool LineScanner::next(const char *& line, size_t& len)
+  {
+    if (_line >= _end) return false;
+
+    while (!_mask)
+    {
+      _block += BLOCK_SIZE;
+      if (_block >= _end)
+      {
+        // final line without a '\n'
+        line = _line;
+        len = _end - _line;
+        _line = _end;
+        return true;
+      }
+      _mask = newline_mask(_block, _end);
+    }
+
+    const char *nl = _block + __builtin_ctzll(_mask);
+    _mask &= _mask - 1;
+
+    line = _line;
+    len = nl - _line;
+    _line = nl + 1;
+    return true;
+  }
+
+  size_t count_lines(const char *begin, const char *end)
+  {
+    size_t count = 0;
+    for (const char *p = begin ; p < end ; p += BLOCK_SIZE)
+    {
+      count += __builtin_popcountll(newline_mask(p, end));
+    }
+
+    if ((begin < end) && (end[-1] != '\n')) count++;
+
+    return count;
+  }
+
+  // trailing '\r' of a CRLF file
+  size_t trim(const char *line, size_t len)
+  {
+    return (len && (line[len - 1] == '\r')) ? len - 1 : len;
+  }
+}
+
+class ArchiveImpl : public Archive
+{
+public:
+  ArchiveImpl(const char *data, size_t size)
+    : _data(data)
+    , _size(size)
+  {
+  }
+
+  virtual ~ArchiveImpl();
+
+  virtual const char *Data() const { return _data; }
+  virtual size_t Size() const { return _size; }
+
+  virtual size_t NumLines() const
+  {
+    return count_lines(_data, _data + _size);
+  }
+
+  virtual size_t Decode(const handler& fn, Metar::parse_mode mode,
+                        uint32_t options) const;
+
+  virtual size_t Decode(vector<MetarRecord>& out, vector<bool> *ok,
+                        Metar::parse_mode mode, uint32_t options) const;
+
+private:
+  const char *_data;
+  size_t _size;
+};
+
+ArchiveImpl::~ArchiveImpl()
+{
+  if (_size)
+  {
+    munmap(const_cast<char *>(_data), _size);
+  }
+}
+
+shared_ptr<Archive> Archive::Open(const char *path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return nullptr;
+
+  struct stat st;
+  if (fstat(fd, &st) < 0)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  size_t size = st.st_size;
+  void *data = nullptr;
+
+  // mmap() rejects zero length mappings
+  if (size)
+  {
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+      close(fd);
+      return nullptr;
+    }
+
+    madvise(data, size, MADV_SEQUENTIAL);
+  }
+
+  // the mapping outlives the descriptor
+  close(fd);
+
+  return make_shared<ArchiveImpl>(static_cast<const char *>(data), size);
+}
+
+size_t ArchiveImpl::Decode(const handler& fn, Metar::parse_mode mode,
+                           uint32_t options) const
+{
+  MetarRecord rec;
+  size_t decoded = 0;
+
+  LineScanner lines(_data, _data + _size);
+  const char *line;
+  size_t len;
+  while (lines.next(line, len))
+  {
+    len = trim(line, len);
+    if (!len) continue;
+
+    bool ok = Metar::Decode(line, len, rec, mode, options);
+    if (ok) decoded++;
+
+    fn(rec, ok);
+  }
+
+  return decoded;
+}
+
+size_t ArchiveImpl::Decode(vector<MetarRecord>& out, vector<bool> *ok,
+                           Metar::parse_mode mode,
+                           uint32_t options) const
+{
+  // upper bound, so neither vector reallocates while decoding
+  size_t num_lines = NumLines();
+
+  out.clear();
+  out.reserve(num_lines);
+  if (ok)
+  {
+    ok->clear();
+    ok->reserve(num_lines);
+  }
+
+  size_t decoded = 0;
+
+  LineScanner lines(_data, _data + _size);
+  const char *line;
+  size_t len;
+  while (lines.next(line, len))
+  {
+    len = trim(line, len);
+    if (!len) continue;
+
+    out.emplace_back();
+    bool success = Metar::Decode(line, len, out.back(), mode, options);
+    if (success) decoded++;
+
+    if (ok) ok->push_back(success);
+  }
+
+  return decoded;
+}
+
+#endif
@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Bump allocator for objects created while decoding
+//
+
+#include "Arena.h"
+
+#ifndef NO_STD
+
+#include <cstdint>
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+namespace
+{
+  inline char *align_up(char *p, size_t align)
+  {
+    uintptr_t u = reinterpret_cast<uintptr_t>(p);
+    return p + ((align - (u % align)) % align);
+  }
+}
+
+shared_ptr<Arena> Arena::Create(size_t block_size)
+{
+  return make_shared<Arena>(block_size);
+}
+
+Arena::Arena(size_t block_size)
+  : Arena(nullptr, 0, block_size)
+{
+}
+
+Arena::Arena(void *buffer, size_t size, size_t block_size)
+  : _buffer(static_cast<char *>(buffer))
+  , _buffer_size(size)
+  , _block_size(block_size)
+  , _pos(_buffer)
+  , _end(_buffer + size)
+  , _blocks(nullptr)
+  , _num_blocks(0)
+  , _finalizers(nullptr)
+{
+}
+
+Arena::~Arena()
+{
+  Release();
+}
+
+void *Arena::Allocate(size_t size, size_t align)
+{
+  char *p = _pos ? align_up(_pos, align) : nullptr;
+  if (!p || (p > _end) || (size > static_cast<size_t>(_end - p)))
+  {
+    add_block(size + align);
+    p = align_up(_pos, align);
+  }
+
+  _pos = p + size;
+
+  return p;
+}
+
+void Arena::add_block(size_t min_size)
+{
+  size_t header = sizeof(Block) + alignof(max_align_t);
+  size_t size = _block_size > min_size + header ? _block_size
+                                                : min_size + header;
+
+  Block *block = static_cast<Block *>(::operator new(size));
+  block->next = _blocks;
+  _blocks = block;
+  _num_blocks++;
+
+  _pos = reinterpret_cast<char *>(block) + sizeof(Block);
+  _end = reinterpret_cast<char *>(block) + size;
+}
+
+void Arena::Release()
+{
+  while (_finalizers)
+  {
+    Finalizer *f = _finalizers;
+    _finalizers = f->next;
+    f->destroy(f->obj);
+  }
+
+  while (_blocks)
+  {
+    Block *block = _blocks;
+    _blocks = block->next;
+    ::operator delete(block);
+  }
+  _num_blocks = 0;
+
+  _pos = _buffer;
+  _end = _buffer + _buffer_size;
+}
+
+void Arena::Reset(void *buffer, size_t size)
+{
+  Release();
+
+  _buffer = static_cast<char *>(buffer);
+  _buffer_size = size;
+  _pos = _buffer;
+  _end = _buffer + size;
+}
+
+#endif
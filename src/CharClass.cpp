@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Character classification of report text, 64 bytes at a time
+//
+
+#include "CharClass.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace Storage_B::Weather;
+
+CharClass::Masks CharClass::ClassifyScalar(const char *str, size_t len)
+{
+  Masks m = { 0, 0, 0 };
+
+  if (len > BLOCK_SIZE) len = BLOCK_SIZE;
+  for (size_t i = 0 ; i < len ; i++)
+  {
+    uint64_t bit = uint64_t(1) << i;
+    char c = str[i];
+
+    if (c == ' ')
+    {
+      m.space |= bit;
+    }
+    else if ((c >= '0') && (c <= '9'))
+    {
+      m.digit |= bit;
+    }
+    else
+    {
+      c |= 0x20;
+      if ((c >= 'a') && (c <= 'z')) m.alpha |= bit;
+    }
+  }
+
+  return m;
+}
+
+CharClass::Masks CharClass::Classify(const char *str, size_t len)
+{
+  if (len < BLOCK_SIZE)
+  {
+    // a partial block can't be loaded without reading past the end
+    return ClassifyScalar(str, len);
+  }
+
+  Masks m = { 0, 0, 0 };
+
+  //
+  // Bytes >= 0x80 compare as negative, so they fail every range test
+  //
+#if defined(__AVX2__)
+  const __m256i space = _mm256_set1_epi8(' ');
+  const __m256i below_0 = _mm256_set1_epi8('0' - 1);
+  const __m256i above_9 = _mm256_set1_epi8('9' + 1);
+  const __m256i lower = _mm256_set1_epi8(0x20);
+  const __m256i below_a = _mm256_set1_epi8('a' - 1);
+  const __m256i above_z = _mm256_set1_epi8('z' + 1);
+
+  for (size_t i = 0 ; i < BLOCK_SIZE ; i += 32)
+  {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str + i));
+    __m256i l = _mm256_or_si256(v, lower);
+
+    __m256i is_space = _mm256_cmpeq_epi8(v, space);
+    __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, below_0),
+                                        _mm256_cmpgt_epi8(above_9, v));
+    __m256i is_alpha = _mm256_and_si256(_mm256_cmpgt_epi8(l, below_a),
+                                        _mm256_cmpgt_epi8(above_z, l));
+
+    m.space |= uint64_t(uint32_t(_mm256_movemask_epi8(is_space))) << i;
+    m.digit |= uint64_t(uint32_t(_mm256_movemask_epi8(is_digit))) << i;
+    m.alpha |= uint64_t(uint32_t(_mm256_movemask_epi8(is_alpha))) << i;
+  }
+#elif defined(__SSE2__)
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i below_0 = _mm_set1_epi8('0' - 1);
+  const __m128i above_9 = _mm_set1_epi8('9' + 1);
+  const __m128i lower = _mm_set1_epi8(0x20);
+  const __m128i below_a = _mm_set1_epi8('a' - 1);
+  const __m128i above_z = _mm_set1_epi8('z' + 1);
+
+  for (size_t i = 0 ; i < BLOCK_SIZE ; i += 16)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+    __m128i l = _mm_or_si128(v, lower);
+
+    __m128i is_space = _mm_cmpeq_epi8(v, space);
+    __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(v, below_0),
+                                     _mm_cmplt_epi8(v, above_9));
+    __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(l, below_a),
+                                     _mm_cmplt_epi8(l, above_z));
+
+    m.space |= uint64_t(_mm_movemask_epi8(is_space)) << i;
+    m.digit |= uint64_t(_mm_movemask_epi8(is_digit)) << i;
+    m.alpha |= uint64_t(_mm_movemask_epi8(is_alpha)) << i;
+  }
+#else
+  m = ClassifyScalar(str, len);
+#endif
+
+  return m;
+}
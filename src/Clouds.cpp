@@ -5,17 +5,20 @@
 //
 
 #include "Clouds.h"
+#include "Arena.h"
 
 #ifndef NO_STD
 #include <cstdlib>
 #include <cstring>
-#include <cstring>
+#include <cctype>
 #include <climits>
+#include <cstdint>
 #else
 #include <stdlib.h>
 #include <string.h>
-#include <string.h>
+#include <ctype.h>
 #include <limits.h>
+#include <stdint.h>
 #endif
 
 using namespace std;
@@ -23,40 +26,90 @@ using namespace Storage_B::Weather;
 
 namespace
 {
-  const char *sky_conditions[] =
+  //
+  // Three characters packed into one integer, first character highest.
+  // Codes shorter than three characters are padded with NUL, which
+  // never occurs inside a token.
+  //
+  constexpr uint32_t pack(char a, char b, char c)
+  {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(a)) << 16)
+         | (static_cast<uint32_t>(static_cast<unsigned char>(b)) << 8)
+         | static_cast<uint32_t>(static_cast<unsigned char>(c));
+  }
+
+  constexpr uint32_t pack(const char *str)
+  {
+    return pack(str[0], str[1], str[2]);
+  }
+
+  inline uint32_t pack(const char *str, size_t len)
+  {
+    return pack(str[0], len > 1 ? str[1] : '\0', len > 2 ? str[2] : '\0');
+  }
+
+  struct SkyCondition
   {
-    "SKC",
-    "CLR",
-    "NSC",
-    "FEW",
-    "SCT",
-    "BKN",
-    "OVC"
+    uint32_t key;
+    unsigned char cover;
   };
-  const auto NUM_LAYERS =
-      sizeof(sky_conditions) / sizeof(sky_conditions[0]);
 
-  const char *cloud_types[] =
+  //
+  // Perfect hash of every sky condition, see sky_slot().  The empty
+  // slot holds a key wider than three characters.
+  //
+  const SkyCondition SKY_CONDITIONS[8] =
   {
-    "TCU",
-    "CB",
-    "ACC" 
+    { pack("NSC"), static_cast<unsigned char>(Clouds::cover::NSC) },
+    { pack("OVC"), static_cast<unsigned char>(Clouds::cover::OVC) },
+    { pack("FEW"), static_cast<unsigned char>(Clouds::cover::FEW) },
+    { 0xFFFFFFFFUL, 0 },
+    { pack("SCT"), static_cast<unsigned char>(Clouds::cover::SCT) },
+    { pack("SKC"), static_cast<unsigned char>(Clouds::cover::SKC) },
+    { pack("BKN"), static_cast<unsigned char>(Clouds::cover::BKN) },
+    { pack("CLR"), static_cast<unsigned char>(Clouds::cover::CLR) }
+  };
+
+  //
+  // Multiplicative hash of the packed key, chosen to be collision free
+  // over SKY_CONDITIONS
+  //
+  inline unsigned int sky_slot(uint32_t key)
+  {
+    return static_cast<uint32_t>(key * 6787UL) >> 29;
+  }
+
+  //
+  // Cloud types, in Clouds::type order
+  //
+  const uint32_t CLOUD_TYPES[] =
+  {
+    pack("TCU"),
+    pack("CB\0"),
+    pack("ACC")
   };
   const auto NUM_CLOUDS =
-      sizeof(cloud_types) / sizeof(cloud_types[0]);
+      sizeof(CLOUD_TYPES) / sizeof(CLOUD_TYPES[0]);
+
+  //
+  // Bounded atoi(): at most three leading digits
+  //
+  int altitude(const char *str, size_t len)
+  {
+    int alt = 0;
+    for (size_t i = 0 ; (i < len) && (i < 3) && isdigit(str[i]) ; i++)
+    {
+      alt = (alt * 10) + (str[i] - '0');
+    }
+
+    return alt;
+  }
 }
 
 class CloudsImpl : public Clouds
 {
 public:
-  CloudsImpl(bool temp, cover c, int a = INT_MIN,
-                   type t = type::undefined)
-    : _cover(c)
-    , _alt(a)
-    , _tempo(temp)
-    , _type(t)
-  {
-  }
+  CloudsImpl(const CloudLayer& layer) : _layer(layer) {}
 
   virtual ~CloudsImpl() = default;
 
@@ -65,18 +118,15 @@ public:
   CloudsImpl(const CloudsImpl&) = delete;
   CloudsImpl& operator=(const CloudsImpl&) = delete;
 
-  virtual cover Cover() const { return _cover; } 
-  virtual int Altitude() const { return _alt; }
-  virtual bool hasAltitude() const { return _alt != INT_MIN; }
-  virtual type CloudType() const { return _type; }
-  virtual bool hasCloudType() const { return _type != type::undefined; }
-  virtual bool Temporary() const { return _tempo; }
+  virtual cover Cover() const { return _layer.Cover(); } 
+  virtual int Altitude() const { return _layer.Altitude(); }
+  virtual bool hasAltitude() const { return _layer.hasAltitude(); }
+  virtual type CloudType() const { return _layer.CloudType(); }
+  virtual bool hasCloudType() const { return _layer.hasCloudType(); }
+  virtual bool Temporary() const { return _layer.Temporary(); }
 
 private:
-  cover _cover;
-  int _alt;
-  bool _tempo;
-  type _type;
+  CloudLayer _layer;
 };
 
 #ifndef NO_STD
@@ -86,65 +136,89 @@ private:
 #endif
 Clouds::Create(const char *str, bool tempo)
 {
-  bool cloud_flg = false;
+  return Create(str, strlen(str), tempo);
+}
 
-  unsigned int idx = 0;
+#ifndef NO_STD
+          std::shared_ptr<Clouds>
+#else
+          Clouds *
+#endif
+Clouds::Create(const char *str, size_t len, bool tempo)
+{
+  CloudLayer layer;
 
-  for (unsigned int i = 0 ; i < NUM_LAYERS ; i++)
+  if (Decode(str, len, tempo, layer))
   {
-    if (!strncmp(sky_conditions[i], str, strlen(sky_conditions[i])))
-    {
-      cloud_flg = true;
-      idx = i;
-      break;
-    }
+    return Create(layer);
   }
 
-  if (cloud_flg)
-  {
-    if (str[3] == '\0')
-    {
+  return nullptr;
+}
+
 #ifndef NO_STD
-      return make_shared<CloudsImpl>(tempo,
-                static_cast<Clouds::cover>(idx));
+          std::shared_ptr<Clouds>
 #else
-      return new CloudsImpl(tempo,
-                static_cast<Clouds::cover>(idx)); 
+          Clouds *
 #endif
-    }
-    else if (str[6] == '\0')
-    {
+Clouds::Create(const CloudLayer& layer)
+{
 #ifndef NO_STD
-      return make_shared<CloudsImpl>(tempo,
-              static_cast<Clouds::cover>(idx), atoi(str + 3));
+  return make_shared<CloudsImpl>(layer);
 #else
-      return
-          new CloudsImpl(tempo, static_cast<Clouds::cover>(idx), 
-                               atoi(str + 3));
+  return new CloudsImpl(layer);
 #endif
-    }
-    else
-    {
-      Clouds::type t = Clouds::type::undefined;
-      for (size_t j = 0 ; j < NUM_CLOUDS ; j++)
-      {
-        if (!strcmp(str + 6, cloud_types[j]))
-        {
-          t = static_cast<Clouds::type>(j);
-          break;
-        }
-      } 
+}
+
 #ifndef NO_STD
-      return make_shared<CloudsImpl>(tempo,
-              static_cast<Clouds::cover>(idx), atoi(str + 3), t);
-#else
-      return
-          new CloudsImpl(tempo, static_cast<Clouds::cover>(idx), 
-                               atoi(str + 3), t);
+Clouds *Clouds::Create(const CloudLayer& layer, Arena& arena)
+{
+  return arena.New<CloudsImpl>(layer);
+}
+
+size_t Clouds::ArenaSize()
+{
+  return Arena::Footprint(sizeof(CloudsImpl));
+}
 #endif
+
+bool Clouds::Decode(const char *str, size_t len, bool tempo,
+                    CloudLayer& layer)
+{
+  if (len < 3)
+  {
+    return false;
+  }
+
+  uint32_t key = pack(str);
+  const SkyCondition& sky = SKY_CONDITIONS[sky_slot(key)];
+  if (sky.key != key)
+  {
+    return false;
+  }
+
+  layer.cover = sky.cover;
+  layer.altitude = CloudLayer::NO_ALTITUDE;
+  layer.type = 0;
+  layer.temporary = tempo;
+
+  if (len > 3)
+  {
+    layer.altitude = altitude(str + 3, len - 3);
+  }
+
+  if ((len > 6) && (len <= 9))
+  {
+    key = pack(str + 6, len - 6);
+    for (size_t j = 0 ; j < NUM_CLOUDS ; j++)
+    {
+      if (CLOUD_TYPES[j] == key)
+      {
+        layer.type = j + 1;
+        break;
+      }
     }
   }
 
-  return nullptr;
+  return true;
 }
-
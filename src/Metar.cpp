@@ -5,18 +5,27 @@
 //
 
 #include "Metar.h"
+#include "MetarRecord.h"
+#include "EventDecoder.h"
+#include "MetarParser.h"
+#include "Arena.h"
+#include "Units.h"
 
 #ifndef NO_STD
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <cstdlib>
-#include <cctype>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
 
 #include <climits>
 #include <cfloat>
 #else
 #include <string.h>
 #include <stdlib.h>
-#include <ctype.h>
 
 #include <limits.h>
 #include <float.h>
@@ -27,319 +36,415 @@ using namespace Storage_B::Weather;
 
 namespace
 {
-  const char *WIND_SPEED_KT = "KT";
-  const char *WIND_SPEED_MPS = "MPS";
-  const char *WIND_SPEED_KPH = "KPH";
+  //
+  // Factors for Metar::NORMALIZE
+  //
+  const double MPS_PER_KNOT = UnitConversion<Knots, MetersPerSecond>::SCALE;
+  const double MPS_PER_KPH =
+      UnitConversion<KilometersPerHour, MetersPerSecond>::SCALE;
+  const double METERS_PER_SM = UnitConversion<StatuteMiles, Meters>::SCALE;
+  const double HPA_PER_INHG =
+      UnitConversion<InchesOfMercury, HectoPascal>::SCALE;
+  const int CAVOK_METERS = 10000;
+
+  // value * scale to the nearest integer, for non-negative values
+  inline int scaled(double value, double scale)
+  {
+    return static_cast<int>((value * scale) + 0.5);
+  }
 
-  const char *VIS_UNITS_SM = "SM";
-    
-  bool match(const char *pattern, const char *str,
-      bool (*f)(size_t, size_t))
+  // cm/s
+  inline int to_cms(int speed, Metar::speed_units units)
   {
-    size_t len = strlen(pattern);
-    if (str && f(len, strlen(str)))
+    switch (units)
     {
-      for (size_t i = 0 ; i < len ; i++)
-      {
-        switch(pattern[i])
-        {
-          case '#':
-            if (!isdigit(str[i])) return false;
-            break;
-
-          case '$':
-            if (!isalpha(str[i])) return false;
-            break;
-
-          default:
-            if (pattern[i] != str[i]) return false;
-            break;
-        }
-      }
-
-      return true;
-    }
+      case Metar::speed_units::KT:
+        return scaled(speed, MPS_PER_KNOT * 100);
+
+      case Metar::speed_units::KPH:
+        return scaled(speed, MPS_PER_KPH * 100);
 
-    return false;
+      case Metar::speed_units::MPS:
+        return speed * 100;
+
+      default:
+        return MetarRecord::INTEGER_UNDEFINED;
+    }
   }
+}
 
-  inline bool match(const char *pattern, const char *str)
-  {
-    return match(pattern, str, [](size_t a, size_t b) { return a == b; });
-  }  
+#ifndef NO_PHENOM
+class PhenomDefault : public Phenom
+{
+public:
+  PhenomDefault() {}
+  
+  PhenomDefault(const PhenomDefault&) = delete;
+  PhenomDefault& operator=(const PhenomDefault&) = delete;
 
-  inline bool starts_with(const char *pattern, const char *str)
-  {
-    return match(pattern, str, [](size_t a, size_t b) { return a <= b; });
-  }  
+  ~PhenomDefault() = default;
 
-  inline bool is_message_type(const char *str)
-  {
-    return !strcmp(str, "METAR") || !strcmp(str, "SPECI");
-  }
+  virtual unsigned int NumPhenom() const { return 0; }
 
-  inline bool is_icao(const char *str)
+  virtual phenom
+#ifndef NO_STD
+      operator[](typename std::vector<Phenom>::size_type
+#else
+      operator[](unsigned int
+#endif
+                 ) const 
   {
-    return match("$$$$", str);
+    return phenom::NONE;
   }
+  
+  virtual intensity Intensity() const { return intensity::NORMAL; } 
+  virtual bool Blowing() const { return false; }
+  virtual bool Freezing() const { return false; }
+  virtual bool Drifting() const { return false; }
+  virtual bool Vicinity() const { return false; }
+  virtual bool Partial() const { return false; }
+  virtual bool Shallow() const { return false; } 
+  virtual bool Patches() const { return false; }
+  virtual bool ThunderStorm() const { return false; }
+  virtual bool Temporary() const { return false; }
+};
 
-  inline bool is_ot(const char *str)
-  {
-    return match("######Z", str);
-  }
+namespace
+{
+  // returned for out of range phenomena, shared by every report
+  const PhenomDefault DEFAULT_PHENOM;
+}
+#endif
 
-  inline bool is_wind(const char *str)
-  {
-    return starts_with("#####", str) 
-        || starts_with("#####G##", str) 
-        || starts_with("######G###", str)
-        || starts_with("VRB", str);
-  }
+#ifndef NO_STD
+//
+// Cloud layers and weather phenomena reported past the MetarRecord caps
+//
+struct SkyOverflow
+{
+#ifndef NO_CLOUDS
+  std::vector<CloudLayer> layers;
+#endif
+#ifndef NO_PHENOM
+  std::vector<PhenomGroup> phenomena;
+#endif
+};
+#endif
 
-  inline bool is_wind_var(const char *str)
+//
+// Fills a MetarRecord from the decoder's events
+//
+class RecordHandler : public MetarHandler
+{
+public:
+  RecordHandler(MetarRecord& rec, uint32_t options)
+    : _rec(rec)
+    , _normalize((options & Metar::NORMALIZE) != 0)
   {
-    return match("###V###", str);
+    _rec.Clear();
   }
 
-  inline bool is_vis(const char *str)
+#ifndef NO_STD
+  //
+  // overflow - receives the groups that do not fit in rec
+  //
+  RecordHandler(MetarRecord& rec, uint32_t options, SkyOverflow *overflow)
+    : RecordHandler(rec, options)
   {
-    if (!strcmp(str, "CAVOK"))
-      return true;
-
-    const char *p = strstr(str, VIS_UNITS_SM);
-    if (!p)
-    {  
-      return match("####", str);
-    }
-
-    auto len = strlen(str); 
-    if ((str + len - p) == 2)
-    {
-      if (!isdigit(str[0]) && (str[0] != 'M')) return false;
-      for (size_t i = 1 ; i < len - 2 ; i++)
-      {
-        if (!isdigit(str[i]) && str[i] != '/') return false;
-      }
+    _overflow = overflow;
+  }
+#endif
 
-      return true;
-    }
+  RecordHandler(const RecordHandler&) = delete;
+  RecordHandler& operator=(const RecordHandler&) = delete;
 
-    return false;
+  void on_message_type(Metar::message_type type)
+  {
+    _rec.message_type = type;
   }
 
-  inline bool is_vert_vis(const char *str)
+  void on_icao(const char *icao)
   {
-    return match("VV###", str);
+    memcpy(_rec.icao, icao, 4);
+    _rec.icao[4] = '\0';
   }
 
-  inline bool is_temp(const char *str)
+  void on_time(int day, int hour, int minute)
   {
-    return match("##/##", str) 
-      || match("##/M##", str) 
-      || match("M##/M##", str)
-      || match("##/", str)
-      || match("M##/", str);
+    _rec.day = day;
+    _rec.hour = hour;
+    _rec.minute = minute;
   }
 
-  inline bool is_altA(const char *str)
+  void on_wind(int dir, int speed, int gust, Metar::speed_units units,
+               bool vrb);
+
+  void on_wind_var(int min_dir, int max_dir)
   {
-    return match("A####", str);
+    _rec.min_wind_dir = min_dir;
+    _rec.max_wind_dir = max_dir;
   }
 
-  inline bool is_altQ(const char *str)
+  void on_visibility(int vis, Metar::distance_units units, bool lt);
+
+  void on_cavok()
   {
-    return match("Q####", str);
+    _rec.cavok = true;
+    if (_normalize) _rec.vis_m = CAVOK_METERS;
   }
 
-  inline bool is_rmk(const char *str)
+  void on_vertical_visibility(int vert_vis) { _rec.vert_vis = vert_vis; }
+
+#ifndef NO_CLOUDS
+  void on_cloud_layer(const CloudLayer& layer)
   {
-    return strcmp(str, "RMK") == 0;
+    if (_rec.num_layers < MetarRecord::MAX_CLOUD_LAYERS)
+    {
+      _rec.layers[_rec.num_layers++] = layer;
+    }
+    else
+    {
+      _rec.truncated = true;
+#ifndef NO_STD
+      if (_overflow) _overflow->layers.push_back(layer);
+#endif
+    }
   }
+#endif
 
-  inline bool is_tempo(const char *str)
+#ifndef NO_PHENOM
+  void on_phenom(const PhenomGroup& group)
   {
-    return strcmp(str, "TEMPO") == 0;
+    if (_rec.num_phenomena < MetarRecord::MAX_PHENOMENA)
+    {
+      _rec.phenomena[_rec.num_phenomena++] = group;
+    }
+    else
+    {
+      _rec.truncated = true;
+#ifndef NO_STD
+      if (_overflow) _overflow->phenomena.push_back(group);
+#endif
+    }
   }
+#endif
+
+  void on_temperature(int temp, int dew);
+
+  void on_altimeter_a(int altimeter);
+
+  void on_altimeter_q(int altimeter);
 
-  inline bool is_slp(const char *str)
+  void on_sea_level_pressure(int slp) { _rec.slp = slp; }
+
+  void on_temperature_na(int temp, int dew);
+
+private:
+  MetarRecord& _rec;
+  bool _normalize;
+#ifndef NO_STD
+  SkyOverflow *_overflow = nullptr;
+#endif
+};
+
+void RecordHandler::on_wind(int dir, int speed, int gust,
+                            Metar::speed_units units, bool vrb)
+{
+  _rec.wind_dir = dir;
+  _rec.wind_spd = speed;
+  _rec.gust = gust;
+  _rec.wind_speed_units = units;
+  _rec.vrb = vrb;
+
+  if (_normalize)
   {
-    return match("SLP###", str);
+    _rec.wind_spd_cms = to_cms(speed, units);
+    if (_rec.hasWindGust())
+    {
+      _rec.gust_cms = to_cms(gust, units);
+    }
   }
+}
 
-  inline bool is_tempNA(const char *str)
+void RecordHandler::on_visibility(int vis, Metar::distance_units units,
+                                  bool lt)
+{
+  _rec.vis = vis;
+  _rec.vis_units = units;
+  _rec.vis_lt = lt;
+
+  if (_normalize)
   {
-    return starts_with("T####", str);
+    _rec.vis_m = (units == Metar::distance_units::SM)
+        ? scaled(_rec.Visibility(), METERS_PER_SM) : vis;
   }
-    
-  inline int temp(char *val)
+}
+
+void RecordHandler::on_temperature(int temp, int dew)
+{
+  _rec.temp = temp;
+  _rec.dew = dew;
+
+  // the T remark group, when present, comes later and is more precise
+  if (_normalize)
   {
-    if (val[0] == 'M') val[0] = '-';
-    return atoi(val);
+    if (!_rec.hasTemperatureNA()) _rec.temp_dc = temp * 10;
+    if (_rec.hasDewPoint() && !_rec.hasDewPointNA())
+    {
+      _rec.dew_dc = dew * 10;
+    }
   }
-    
-  inline double tempNA(char *val)
+}
+
+void RecordHandler::on_altimeter_a(int altimeter)
+{
+  _rec.altimeterA = altimeter;
+  if (_normalize && !_rec.hasAltimeterQ())
   {
-    if (val[0] == '1') val[0] = '-';
-    return atof(val) / 10.0;
+    _rec.pressure_dhpa = scaled(_rec.AltimeterA(), HPA_PER_INHG * 10);
   }
 }
 
-#ifndef NO_PHENOM
-class PhenomDefault : public Phenom
+void RecordHandler::on_altimeter_q(int altimeter)
 {
-public:
-  PhenomDefault() {}
-  
-  PhenomDefault(const PhenomDefault&) = delete;
-  PhenomDefault& operator=(const PhenomDefault&) = delete;
-
-  ~PhenomDefault() = default;
+  _rec.altimeterQ = altimeter;
+  if (_normalize) _rec.pressure_dhpa = altimeter * 10;
+}
 
-  virtual unsigned int NumPhenom() const { return 0; }
+void RecordHandler::on_temperature_na(int temp, int dew)
+{
+  _rec.ftemp = temp;
+  _rec.fdew = dew;
 
-  virtual phenom
-#ifndef NO_STD
-      operator[](typename std::vector<Phenom>::size_type
-#else
-      operator[](unsigned int
-#endif
-                 ) const 
+  if (_normalize)
   {
-    return phenom::NONE;
+    _rec.temp_dc = temp;
+    if (_rec.hasDewPointNA()) _rec.dew_dc = dew;
   }
-  
-  virtual intensity Intensity() const { return intensity::NORMAL; } 
-  virtual bool Blowing() const { return false; }
-  virtual bool Freezing() const { return false; }
-  virtual bool Drifting() const { return false; }
-  virtual bool Vicinity() const { return false; }
-  virtual bool Partial() const { return false; }
-  virtual bool Shallow() const { return false; } 
-  virtual bool Patches() const { return false; }
-  virtual bool ThunderStorm() const { return false; }
-  virtual bool Temporary() const { return false; }
-};
-
-#endif
+}
 
 class MetarImpl : public Metar
 {
 public:
-  MetarImpl(const char *metar_str);
-  MetarImpl(char *metar_str);
+#ifndef NO_STD
+  //
+  // Cloud layers and weather phenomena are created in arena
+  //
+  MetarImpl(const char *metar_str, size_t len, parse_mode mode,
+            unsigned int *predicate_calls, Arena& arena);
 
-#ifdef NO_STD
-  virtual ~MetarImpl();
-#else
   virtual ~MetarImpl() = default;
+
+  //
+  // owner - keeps this report alive, shared by the Layer() handles
+  //
+  void Own(const std::shared_ptr<void>& owner) { _owner = owner; }
+#else
+  MetarImpl(const char *metar_str, size_t len, parse_mode mode,
+            unsigned int *predicate_calls);
+
+  virtual ~MetarImpl();
 #endif
 
   MetarImpl(const MetarImpl&) = delete;
   MetarImpl& operator=(const MetarImpl&) = delete;
 
-  virtual message_type MessageType() const { return _message_type; }
-  virtual bool hasMessageType() const
-  {
-    return _message_type != message_type::undefined;
-  }
+  virtual const MetarRecord& Record() const { return _rec; }
 
-  virtual const char *ICAO() const { return _icao; }
-  virtual bool hasICAO() const { return _icao[0] != '\0'; }
+  virtual message_type MessageType() const { return _rec.message_type; }
+  virtual bool hasMessageType() const { return _rec.hasMessageType(); }
+
+  virtual const char *ICAO() const { return _rec.icao; }
+  virtual bool hasICAO() const { return _rec.hasICAO(); }
       
-  virtual int Day() const { return _day; }
-  virtual bool hasDay() const { return _day != _INTEGER_UNDEFINED; }
+  virtual int Day() const { return _rec.day; }
+  virtual bool hasDay() const { return _rec.hasDay(); }
 
-  virtual int Hour() const { return _hour; }
-  virtual bool hasHour() const { return _hour != _INTEGER_UNDEFINED; }
+  virtual int Hour() const { return _rec.hour; }
+  virtual bool hasHour() const { return _rec.hasHour(); }
 
-  virtual int Minute() const { return _min; }
-  virtual bool hasMinute() const { return _min != _INTEGER_UNDEFINED; }
+  virtual int Minute() const { return _rec.minute; }
+  virtual bool hasMinute() const { return _rec.hasMinute(); }
 
-  virtual int WindDirection() const { return _wind_dir; }
-  virtual bool hasWindDirection() const
-  { 
-    return _wind_dir != _INTEGER_UNDEFINED;
-  }
+  virtual int WindDirection() const { return _rec.wind_dir; }
+  virtual bool hasWindDirection() const { return _rec.hasWindDirection(); }
 
-  virtual bool isVariableWindDirection() const { return _vrb; }
+  virtual bool isVariableWindDirection() const { return _rec.vrb; }
 
-  virtual int WindSpeed() const { return _wind_spd; }
-  virtual bool hasWindSpeed() const { return _wind_spd != _INTEGER_UNDEFINED; }
+  virtual int WindSpeed() const { return _rec.wind_spd; }
+  virtual bool hasWindSpeed() const { return _rec.hasWindSpeed(); }
 
-  virtual int WindGust() const { return _gust; }
-  virtual bool hasWindGust() const { return _gust != _INTEGER_UNDEFINED; }
+  virtual int WindGust() const { return _rec.gust; }
+  virtual bool hasWindGust() const { return _rec.hasWindGust(); }
 
-  virtual int MinWindDirection() const { return _min_wind_dir; }
+  virtual int MinWindDirection() const { return _rec.min_wind_dir; }
   virtual int hasMinWindDirection() const
   {
-    return _min_wind_dir != _INTEGER_UNDEFINED;
+    return _rec.hasMinWindDirection();
   }
 
-  virtual int MaxWindDirection() const { return _max_wind_dir; }
+  virtual int MaxWindDirection() const { return _rec.max_wind_dir; }
   virtual int hasMaxWindDirection() const
   {
-    return _max_wind_dir != _INTEGER_UNDEFINED;
+    return _rec.hasMaxWindDirection();
   }
 
-  virtual speed_units WindSpeedUnits() const { return _wind_speed_units; }
-  virtual int hasWindSpeedUnits() const
-  {
-    return _wind_speed_units != speed_units::undefined;
-  }
+  virtual speed_units WindSpeedUnits() const { return _rec.wind_speed_units; }
+  virtual int hasWindSpeedUnits() const { return _rec.hasWindSpeedUnits(); }
 
-  virtual double Visibility() const { return _vis; }
-  virtual bool hasVisibility() const { return _vis != _DOUBLE_UNDEFINED; }
+  virtual double Visibility() const { return _rec.Visibility(); }
+  virtual bool hasVisibility() const { return _rec.hasVisibility(); }
 
-  virtual distance_units VisibilityUnits() const { return _vis_units; }
+  virtual distance_units VisibilityUnits() const { return _rec.vis_units; }
   virtual bool hasVisibilityUnits() const
   {
-    return _vis_units != distance_units::undefined;
+    return _rec.hasVisibilityUnits();
   }
 
-  virtual bool isVisibilityLessThan() const { return _vis_lt; }
+  virtual bool isVisibilityLessThan() const { return _rec.vis_lt; }
   
-  virtual bool isCAVOK() const { return _cavok; }
+  virtual bool isCAVOK() const { return _rec.cavok; }
       
-  virtual int VerticalVisibility() const { return _vert_vis; }
+  virtual int VerticalVisibility() const { return _rec.vert_vis; }
   virtual bool hasVerticalVisibility() const
   {
-    return _vert_vis != _INTEGER_UNDEFINED;
+    return _rec.hasVerticalVisibility();
   }
   
-  virtual int Temperature() const { return _temp; }
-  virtual bool hasTemperature() const { return _temp != _INTEGER_UNDEFINED; }
+  virtual int Temperature() const { return _rec.temp; }
+  virtual bool hasTemperature() const { return _rec.hasTemperature(); }
 
-  virtual int DewPoint() const { return _dew; }
-  virtual bool hasDewPoint() const { return _dew != _INTEGER_UNDEFINED; }
+  virtual int DewPoint() const { return _rec.dew; }
+  virtual bool hasDewPoint() const { return _rec.hasDewPoint(); }
 
-  virtual double AltimeterA() const { return _altimeterA; }
-  virtual bool hasAltimeterA() const
+  virtual double AltimeterA() const { return _rec.AltimeterA(); }
+  virtual bool hasAltimeterA() const { return _rec.hasAltimeterA(); }
+
+  virtual int AltimeterQ() const { return _rec.altimeterQ; }
+  virtual bool hasAltimeterQ() const { return _rec.hasAltimeterQ(); }
+
+  virtual double SeaLevelPressure() const
   {
-    return _altimeterA != _DOUBLE_UNDEFINED;
+    return _rec.SeaLevelPressure();
   }
-
-  virtual int AltimeterQ() const { return _altimeterQ; }
-  virtual bool hasAltimeterQ() const
+  virtual bool hasSeaLevelPressure() const
   {
-    return _altimeterQ != _INTEGER_UNDEFINED;
+    return _rec.hasSeaLevelPressure();
   }
 
-  virtual double SeaLevelPressure() const { return _slp; }
-  virtual bool hasSeaLevelPressure() const { return _slp != _DOUBLE_UNDEFINED; }
-
-  virtual double TemperatureNA() const { return _ftemp; }
-  virtual bool hasTemperatureNA() const { return _ftemp != _DOUBLE_UNDEFINED; }
+  virtual double TemperatureNA() const { return _rec.TemperatureNA(); }
+  virtual bool hasTemperatureNA() const { return _rec.hasTemperatureNA(); }
 
-  virtual double DewPointNA() const { return _fdew; }
-  virtual bool hasDewPointNA() const { return _fdew != _DOUBLE_UNDEFINED; }
+  virtual double DewPointNA() const { return _rec.DewPointNA(); }
+  virtual bool hasDewPointNA() const { return _rec.hasDewPointNA(); }
 
 #ifndef NO_CLOUDS
   virtual unsigned int NumCloudLayers() const
-  { 
-#ifdef NO_STD
+  {
+#ifndef NO_STD
     return _num_layers;
 #else
-    return _layers.size(); 
+    return _rec.num_layers;
 #endif
   }
 
@@ -352,20 +457,33 @@ public:
   {
     if (idx < NumCloudLayers())
     {
+#ifndef NO_STD
+      return std::shared_ptr<Clouds>(_owner.lock(), _layers[idx]);
+#else
       return _layers[idx];
+#endif
     }
 
     return nullptr;
   }
+
+  virtual const CloudLayer *CloudLayers() const
+  {
+#ifndef NO_STD
+    return _all_layers;
+#else
+    return _rec.layers;
+#endif
+  }
 #endif
 
 #ifndef NO_PHENOM
   unsigned int NumPhenomena() const
   {
-#ifdef NO_STD
+#ifndef NO_STD
     return _num_phenomena;
 #else
-    return _phenomena.size();
+    return _rec.num_phenomena;
 #endif
   }
 
@@ -376,554 +494,733 @@ public:
       return *_phenomena[idx];
     }
 
-    return *_default_phenom;
+    return DEFAULT_PHENOM;
   }
 #endif
 
-private:
-  MetarImpl();
-
-  void parse(char *metar_str);
-  void parse(const char *metar_str);
-
-  void parse_message_type(const char *str);
-
-  void parse_icao(const char *str);
-
-  void parse_ot(const char *str);
-
-  void parse_wind(const char *str);
-
-  void parse_wind_var(const char *str);
-
-  void parse_vis(const char *str);
-
-  void parse_cloud_layer(const char *str);
-  
-  void parse_vert_vis(const char *str);
-  
-  void parse_temp(const char *str);
-
-  void parse_alt(const char *str);
-
-  void parse_slp(const char *str);
-
-  void parse_tempNA(const char *str);
-
-  void parse_phenom(const char *str);
-
-  message_type _message_type;
-
-  char _icao[5];
-
-  int _day;
-  int _hour;
-  int _min;
-
-  int _wind_dir;
-  int _wind_spd;
-  int _gust;
-  speed_units _wind_speed_units;
-
-  int _min_wind_dir;
-  int _max_wind_dir;
-  bool _vrb;
-
-  double _vis;
-  distance_units _vis_units;
-  bool _vis_lt;
-  bool _cavok;
-
-#ifndef NO_CLOUDS
+protected:
 #ifndef NO_STD
-  std::vector<std::shared_ptr<Clouds>>
+  MetarImpl() = default;
+
+  //
+  // Cloud layers and weather phenomena of _rec followed by those of
+  // overflow, created in arena
+  //
+  void create_sky(Arena& arena, const SkyOverflow& overflow);
+
+  //
+  // Forget the sky, before the arena holding it is released
+  //
+  void clear_sky();
 #else
-  Clouds **
+  void create_sky();
 #endif
-    _layers;
 
-#ifdef NO_STD
-  unsigned int _num_layers;
-#endif
-#endif
+  MetarRecord _rec;
 
-#ifndef NO_PHENOM
 #ifndef NO_STD
-  std::vector<std::shared_ptr<Phenom>>
-#else
-  Phenom **
-#endif
-    _phenomena;
-#ifdef NO_STD
- unsigned int _num_phenomena;
-#endif
-#endif
-
-  int _vert_vis;
-
-  int _temp;
-  int _dew;
-
-  double _altimeterA;
-
-  int _altimeterQ;
-
-  bool _rmk;
-  bool _tempo;
-
-  double _slp;
-
-  double _ftemp;
-  double _fdew;
-
-  const char *_previous_element;
-
-  static const int _INTEGER_UNDEFINED;
-  static const double _DOUBLE_UNDEFINED;
-
+  // every group reported, the caps of _rec do not apply
 #ifndef NO_CLOUDS
-#ifdef NO_STD
-  static const unsigned int _MAX_CLOUD_LAYERS;
-#endif
+  unsigned int _num_layers = 0;
+  const CloudLayer *_all_layers = nullptr;
+  Clouds **_layers = nullptr;
 #endif
 
 #ifndef NO_PHENOM
-#ifndef NO_STD
-  std::shared_ptr<Phenom>
-#else
-  Phenom *
+  unsigned int _num_phenomena = 0;
+  Phenom **_phenomena = nullptr;
 #endif
-  _default_phenom;
-#ifdef NO_STD
-  static const unsigned int _MAX_PHENOM;
-#endif
-#endif
-};
-   
-const int MetarImpl::_INTEGER_UNDEFINED = INT_MIN;
-const double MetarImpl::_DOUBLE_UNDEFINED = DBL_MAX;
-
-#ifdef NO_STD
+#else
 #ifndef NO_CLOUDS
-const unsigned int MetarImpl::_MAX_CLOUD_LAYERS = 6;
+  Clouds *_layers[MetarRecord::MAX_CLOUD_LAYERS];
 #endif
+
 #ifndef NO_PHENOM
-const unsigned int MetarImpl::_MAX_PHENOM = 16;
+  Phenom *_phenomena[MetarRecord::MAX_PHENOMENA];
 #endif
 #endif
 
 #ifndef NO_STD
-std::shared_ptr<Metar>
-#else
-Metar *
-#endif
-Metar::Create(const char *metar_str)
-{
-#ifndef NO_STD
-  return make_shared<MetarImpl>(metar_str);
-#else
-  return new MetarImpl(metar_str);
+  std::weak_ptr<void> _owner;
 #endif
-}
+};
 
 #ifndef NO_STD
-std::shared_ptr<Metar>
-#else
-Metar *
-#endif
-Metar::Create(char *metar_str)
+namespace
 {
-#ifndef NO_STD
-  return make_shared<MetarImpl>(metar_str);
-#else
-  return new MetarImpl(metar_str);
-#endif
-}
+  //
+  // Metar::Decode(), keeping the groups past the caps of rec in overflow
+  //
+  bool decode(const char *metar_str, size_t len, MetarRecord& rec,
+              Metar::parse_mode mode, uint32_t options,
+              unsigned int *predicate_calls, SkyOverflow& overflow)
+  {
+    RecordHandler handler(rec, options, &overflow);
 
-MetarImpl::MetarImpl()
-  : _message_type(message_type::undefined)
-  , _day(_INTEGER_UNDEFINED)
-  , _hour(_INTEGER_UNDEFINED)
-  , _min(_INTEGER_UNDEFINED)
-  , _wind_dir(_INTEGER_UNDEFINED) 
-  , _wind_spd(_INTEGER_UNDEFINED)
-  , _gust(_INTEGER_UNDEFINED)
-  , _wind_speed_units(speed_units::undefined)
-  , _min_wind_dir(_INTEGER_UNDEFINED)
-  , _max_wind_dir(_INTEGER_UNDEFINED)
-  , _vrb(false)
-  , _vis(_DOUBLE_UNDEFINED)
-  , _vis_units(distance_units::undefined)
-  , _vis_lt(false)
-  , _cavok(false)
-#ifdef NO_STD
-#ifndef NO_CLOUDS
-  , _num_layers(0)
-#endif
-#ifndef NO_PHENOM
-  , _num_phenomena(0)
-#endif
-#endif
-  , _vert_vis(_INTEGER_UNDEFINED)
-  , _temp(_INTEGER_UNDEFINED) 
-  , _dew(_INTEGER_UNDEFINED)
-  , _altimeterA(_DOUBLE_UNDEFINED)
-  , _altimeterQ(_INTEGER_UNDEFINED)
-  , _rmk(false)
-  , _tempo(false)
-  , _slp(_DOUBLE_UNDEFINED)
-  , _ftemp(_DOUBLE_UNDEFINED) 
-  , _fdew(_DOUBLE_UNDEFINED)
-  , _previous_element(nullptr)
-{
-  _icao[0] = '\0';
+    return EventDecoder::Decode(metar_str, len, handler, mode,
+                                predicate_calls, options);
+  }
 
-#ifdef NO_STD
+  //
+  // Arena space for an array of n elements of size bytes
+  //
+  size_t array_size(size_t n, size_t size)
+  {
+    return n ? n * size + alignof(max_align_t) : 0;
+  }
+
+  //
+  // Arena space for the cloud layers and weather phenomena of rec and
+  // overflow
+  //
+  size_t sky_size(const MetarRecord& rec, const SkyOverflow& overflow)
+  {
+    size_t size = 0;
 #ifndef NO_CLOUDS
-  _layers = new Clouds*[_MAX_CLOUD_LAYERS];
-#endif
-#ifndef NO_PHENOM
-  _phenomena = new Phenom*[_MAX_PHENOM];
-#endif
+    size_t layers = rec.num_layers + overflow.layers.size();
+    size += layers * Clouds::ArenaSize()
+          + array_size(layers, sizeof(Clouds *));
+    if (!overflow.layers.empty())
+    {
+      size += array_size(layers, sizeof(CloudLayer));
+    }
 #endif
-
 #ifndef NO_PHENOM
-#ifdef NO_STD
-  _default_phenom = new PhenomDefault();
-#else
-  _default_phenom = make_shared<PhenomDefault>();
+    size_t phenomena = rec.num_phenomena + overflow.phenomena.size();
+    size += phenomena * Phenom::ArenaSize()
+          + array_size(phenomena, sizeof(Phenom *));
 #endif
-#endif
-
+    return size;
+  }
 }
 
-MetarImpl::MetarImpl(const char *metar_str) : MetarImpl()
+//
+// A decoded report followed by the arena buffer for its sky, both in one
+// heap block
+//
+class StandaloneMetarImpl : public MetarImpl
 {
-  parse(metar_str);
-}
+public:
+  static std::shared_ptr<Metar> Create(const MetarRecord& rec,
+                                       const SkyOverflow& overflow);
 
-MetarImpl::MetarImpl(char *metar_str) : MetarImpl()
-{
-  parse(metar_str);
-}
+private:
+  StandaloneMetarImpl(const MetarRecord& rec, const SkyOverflow& overflow,
+                      char *buffer, size_t size)
+    : MetarImpl()
+    , _arena(buffer, size)
+  {
+    _rec = rec;
+    create_sky(_arena, overflow);
+  }
 
-#ifdef NO_STD
-MetarImpl::~MetarImpl()
+  // ends the report and frees its block
+  struct Deleter
+  {
+    void operator()(StandaloneMetarImpl *metar) const
+    {
+      metar->~StandaloneMetarImpl();
+      ::operator delete(metar);
+    }
+  };
+
+  Arena _arena;
+};
+
+std::shared_ptr<Metar> StandaloneMetarImpl::Create(
+    const MetarRecord& rec, const SkyOverflow& overflow)
 {
-#ifndef NO_CLOUDS
-  for (size_t i = 0 ; i < _num_layers ; i++)
+  const size_t align = alignof(max_align_t);
+  const size_t head =
+      (sizeof(StandaloneMetarImpl) + align - 1) / align * align;
+  const size_t size = sky_size(rec, overflow);
+
+  char *block = static_cast<char *>(::operator new(head + size));
+  StandaloneMetarImpl *metar;
+  try
   {
-    delete _layers[i];
+    metar = new (block) StandaloneMetarImpl(rec, overflow, block + head,
+                                            size);
   }
-  delete[] _layers;
-#endif
-
-#ifndef NO_PHENOM
-  for (size_t i = 0 ; i < _num_phenomena ; i++)
+  catch (...)
   {
-    delete _phenomena[i];
+    ::operator delete(block);
+    throw;
   }
 
-  delete[] _phenomena;
-
-  delete _default_phenom;
-#endif
+  // the deleter runs if the control block cannot be allocated
+  std::shared_ptr<StandaloneMetarImpl> owner(metar, Deleter());
+  metar->Own(owner);
+  return owner;
 }
-#endif
 
-void MetarImpl::parse(const char *metar_str)
+//
+// Arena over a heap buffer grown to fit the sky of the current record
+//
+class MetarStorage
 {
-  char *metar_dup = strdup(metar_str);
-  parse(metar_dup);
-  free(metar_dup);
-}
+protected:
+  MetarStorage() = default;
 
-void MetarImpl::parse(char *metar_str)
-{
-  char *el = strtok(metar_str, " ");
-  while (el)
+  MetarStorage(const MetarStorage&) = delete;
+  MetarStorage& operator=(const MetarStorage&) = delete;
+
+  //
+  // Arena with room for size bytes, releases what it held
+  //
+  Arena& storage(size_t size)
   {
-    if (!hasMessageType() && is_message_type(el))
-    {
-      parse_message_type(el);
-    }
-    else if (!hasICAO() && is_icao(el))
-    {
-      parse_icao(el);
-    }
-    else if (!hasMinute() && is_ot(el))
-    {
-      parse_ot(el);
-    }
-    else if (!hasWindSpeed() && is_wind(el))
-    {
-      parse_wind(el);
-    }
-    else if (!hasMinWindDirection() && is_wind_var(el))
-    {
-      parse_wind_var(el);
-    }
-    else if (!hasVisibility() && !_cavok && is_vis(el))
-    {
-      parse_vis(el);
-    }
-    else if (!hasVerticalVisibility() && is_vert_vis(el))
-    {
-      parse_vert_vis(el);
-    }
-    else if (!hasTemperature() && is_temp(el))
+    if (size > _capacity)
     {
-      parse_temp(el);
-    } 
-    else if (!hasAltimeterA() && is_altA(el))
-    {
-      parse_alt(el);
-    }
-    else if (!hasAltimeterQ() && is_altQ(el))
-    {
-      parse_alt(el);
-    }
-    else if (!_tempo && is_tempo(el))
-    {
-      _tempo = true;
+      _buffer.reset(new char[size]);
+      _capacity = size;
+      _arena.Reset(_buffer.get(), _capacity);
     }
-    else if (!_rmk && is_rmk(el))
-    {
-      _rmk = true;
-    }
-    else if (!hasSeaLevelPressure() && is_slp(el))
-    {
-      parse_slp(el);
-    }
-    else if (!hasTemperatureNA() && is_tempNA(el))
+    else
     {
-      parse_tempNA(el);
+      _arena.Release();
     }
-    else if (!_rmk)
+
+    return _arena;
+  }
+
+  unique_ptr<char[]> _buffer;
+  size_t _capacity = 0;
+  Arena _arena;
+};
+
+//
+// A report decoded again in place for every Parse().  The buffer only
+// grows, so once it has held the largest sky seen no more allocation is
+// needed.
+//
+class ReusableMetarImpl : private MetarStorage, public MetarImpl
+{
+public:
+  ReusableMetarImpl() = default;
+
+#ifndef NO_CLOUDS
+  // a copy, the next Parse() reuses the layer in the arena
+  virtual std::shared_ptr<Clouds> Layer(unsigned int idx) const
+  {
+    if (idx < NumCloudLayers())
     {
-      parse_cloud_layer(el);
-      parse_phenom(el);
+      return Clouds::Create(CloudLayers()[idx]);
     }
 
-    _previous_element = el;
+    return nullptr;
+  }
+#endif
+
+  bool Parse(const char *metar_str, size_t len, parse_mode mode,
+             uint32_t options)
+  {
+    Reset();
+
+    SkyOverflow overflow;
+    bool decoded = decode(metar_str, len, _rec, mode, options, nullptr,
+                          overflow);
+    create_sky(storage(sky_size(_rec, overflow)), overflow);
 
-    el = strtok(nullptr, " ");
+    return decoded;
   }
-}
 
-void MetarImpl::parse_message_type(const char *str)
-{
-  _message_type = str[0] == 'S' ? message_type::SPECI : message_type::METAR;
-}
+  void Reset()
+  {
+    clear_sky();
+    _arena.Release();
+    _rec.Clear();
+  }
+};
 
-void MetarImpl::parse_icao(const char *str)
+class MetarParserImpl : public MetarParser
 {
-  strcpy(_icao, str);
-}
+public:
+  MetarParserImpl() = default;
 
-void MetarImpl::parse_ot(const char *str)
-{
-  char val[3];
+  virtual ~MetarParserImpl() = default;
 
-  strncpy(val, str, 2);
-  val[2] = '\0';
-  _day = atoi(val);
+  virtual bool Parse(const char *metar_str, size_t len,
+                     Metar::parse_mode mode, uint32_t options)
+  {
+    return _metar.Parse(metar_str, len, mode, options);
+  }
 
-  strncpy(val, str + 2, 2);
-  val[2] = '\0';
-  _hour = atoi(val);
+  virtual void Reset() { _metar.Reset(); }
 
-  _min = atoi(str + 4);
-}
+  virtual const Metar& Report() const { return _metar; }
+
+private:
+  ReusableMetarImpl _metar;
+};
 
-void MetarImpl::parse_wind(const char *str)
+//
+// Keeps a copy of the report and decodes its main body up front, in the
+// one pass that matches every group as Create does.  That pass keeps
+// where the sky groups (cloud layers, vertical visibility, weather
+// phenomena) and the remarks are; each section is decoded from those
+// groups alone on first access to one of its fields, once, by whichever
+// thread gets there first.
+//
+class LazyMetarImpl : private MetarStorage, public MetarImpl
 {
-  if (strstr(str, WIND_SPEED_MPS))
+public:
+  LazyMetarImpl(const char *metar_str, size_t len);
+
+  virtual const MetarRecord& Record() const
   {
-    _wind_speed_units = speed_units::MPS;
+    sky();
+    remarks();
+    return _rec;
   }
-  else if (strstr(str, WIND_SPEED_KPH))
+
+  virtual int VerticalVisibility() const
   {
-    _wind_speed_units = speed_units::KPH;
+    sky();
+    return MetarImpl::VerticalVisibility();
   }
-  else if (strstr(str, WIND_SPEED_KT))
+  virtual bool hasVerticalVisibility() const
   {
-    _wind_speed_units = speed_units::KT;
+    sky();
+    return MetarImpl::hasVerticalVisibility();
   }
 
-  char val[4];
+  virtual double SeaLevelPressure() const
+  {
+    remarks();
+    return MetarImpl::SeaLevelPressure();
+  }
+  virtual bool hasSeaLevelPressure() const
+  {
+    remarks();
+    return MetarImpl::hasSeaLevelPressure();
+  }
 
-  if (!strstr(str, "VRB"))
+  virtual double TemperatureNA() const
   {
-    strncpy(val, str, 3);
-    val[3] = '\0';
-    _wind_dir = atoi(val);
+    remarks();
+    return MetarImpl::TemperatureNA();
   }
-  else
+  virtual bool hasTemperatureNA() const
   {
-    _vrb = true;
+    remarks();
+    return MetarImpl::hasTemperatureNA();
   }
- 
-  strncpy(val, str + 3, 3);
-  val[3] = '\0';
-  
-  _wind_spd = atoi(val);
 
-  const char *g = strstr(str, "G");
-  if (g)
+  virtual double DewPointNA() const
   {
-    strncpy(val, g + 1, 3);
-    val[3] = '\0';
-    _gust = atoi(val);
-  } 
-}
+    remarks();
+    return MetarImpl::DewPointNA();
+  }
+  virtual bool hasDewPointNA() const
+  {
+    remarks();
+    return MetarImpl::hasDewPointNA();
+  }
 
-void MetarImpl::parse_wind_var(const char *str)
-{
-  char val[4];
+#ifndef NO_CLOUDS
+  virtual unsigned int NumCloudLayers() const
+  {
+    sky();
+    return MetarImpl::NumCloudLayers();
+  }
 
-  strncpy(val, str, 3);
-  val[3] = '\0';
-  _min_wind_dir = atoi(val);
+  virtual std::shared_ptr<Clouds> Layer(unsigned int idx) const
+  {
+    sky();
+    return MetarImpl::Layer(idx);
+  }
 
-  strcpy(val, str + 4);
-  _max_wind_dir = atoi(val);
-}
+  virtual const CloudLayer *CloudLayers() const
+  {
+    sky();
+    return MetarImpl::CloudLayers();
+  }
+#endif
 
-void MetarImpl::parse_vis(const char *str)
-{
-  if (!strcmp(str, "CAVOK"))
+#ifndef NO_PHENOM
+  virtual unsigned int NumPhenomena() const
   {
-    _cavok = true;
-    return;
+    sky();
+    return MetarImpl::NumPhenomena();
   }
 
-  const char *u = strstr(str, VIS_UNITS_SM);
-  if (!u)
+  virtual const Phenom& Phenomenon(unsigned int idx) const
   {
-    _vis = atof(str);
-    _vis_units = distance_units::M;
+    sky();
+    return MetarImpl::Phenomenon(idx);
   }
-  else
+#endif
+
+private:
+  // fields decoded later
+  static const uint32_t SKY = Metar::CLOUDS | Metar::PHENOMENA;
+  static const uint32_t LATER = SKY | Metar::REMARKS;
+
+  void sky() const { once(_sky_done, &LazyMetarImpl::decode_sky); }
+
+  void remarks() const
+  {
+    once(_remarks_done, &LazyMetarImpl::decode_remarks);
+  }
+
+  //
+  // Calls decode unless done is set.  Cheaper than call_once(), which
+  // costs about as much as decoding a section.
+  //
+  void once(std::atomic<bool>& done, void (LazyMetarImpl::*decode)()) const
   {
-    const char *p = strstr(str, "/");
+    if (done.load(memory_order_acquire)) return;
 
-    if (!p)
+    lock_guard<mutex> lock(_decoding);
+    if (!done.load(memory_order_relaxed))
     {
-      _vis = atof(str);
+      (const_cast<LazyMetarImpl *>(this)->*decode)();
+      done.store(true, memory_order_release);
     }
-    else
+  }
+
+  void decode_sky();
+
+  void decode_remarks();
+
+  std::string _text;
+
+  // the sky and remark groups, in report order
+  std::vector<DeferredGroup> _groups;
+
+  mutable std::mutex _decoding;
+  mutable std::atomic<bool> _sky_done{false};
+  mutable std::atomic<bool> _remarks_done{false};
+};
+
+LazyMetarImpl::LazyMetarImpl(const char *metar_str, size_t len)
+  : MetarStorage()
+  , MetarImpl()
+  , _text(metar_str, len)
+{
+  struct BodyHandler : public RecordHandler
+  {
+    BodyHandler(MetarRecord& rec, std::vector<DeferredGroup>& groups)
+      : RecordHandler(rec, DEFAULT)
+      , groups(groups)
     {
-      char val[4];
-      auto len = p - str;
-      
-      if (str[0] == 'M')
-      {
-        strncpy(val, str + 1, len);
-        _vis_lt = true;
-      }
-      else
-      {
-        strncpy(val, str, len);
-      }
-      val[len] = '\0';
-      double numerator = atof(val);
-
-      len = u - p;
-      strncpy(val, p + 1, len);
-      val[len] = '\0';
-      double denominator = atof(val);
-
-      _vis = numerator / denominator;
-      if (match("#", _previous_element))
-      {
-        _vis += atof(_previous_element);
-      }
     }
-    _vis_units = distance_units::SM;
-  }
+
+    void on_deferred(const DeferredGroup& group) { groups.push_back(group); }
+
+    std::vector<DeferredGroup>& groups;
+  } handler(_rec, _groups);
+
+  // enough for most reports, so one allocation
+  _groups.reserve(16);
+
+  EventDecoder::Decode(_text.data(), _text.size(), handler,
+                       parse_mode::SEQUENTIAL, nullptr,
+                       Metar::ALL_FIELDS & ~LATER, LATER);
 }
 
-void MetarImpl::parse_cloud_layer(const char *str)
+void LazyMetarImpl::decode_sky()
 {
+  MetarRecord sky;
+  SkyOverflow overflow;
+  RecordHandler handler(sky, DEFAULT, &overflow);
+  EventDecoder::Replay(_text.data(), _groups.data(), _groups.size(),
+                       handler, SKY);
+
+  _rec.vert_vis = sky.vert_vis;
+  _rec.truncated = sky.truncated;
+
 #ifndef NO_CLOUDS
-  auto c = Clouds::Create(str, _tempo);
+  _rec.num_layers = sky.num_layers;
+  copy(sky.layers, sky.layers + sky.num_layers, _rec.layers);
+#endif
+
+#ifndef NO_PHENOM
+  _rec.num_phenomena = sky.num_phenomena;
+  copy(sky.phenomena, sky.phenomena + sky.num_phenomena, _rec.phenomena);
+#endif
+
+  create_sky(storage(sky_size(_rec, overflow)), overflow);
+}
+
+void LazyMetarImpl::decode_remarks()
+{
+  MetarRecord rmk;
+  RecordHandler handler(rmk, DEFAULT);
+  EventDecoder::Replay(_text.data(), _groups.data(), _groups.size(),
+                       handler, Metar::REMARKS);
+
+  _rec.slp = rmk.slp;
+  _rec.ftemp = rmk.ftemp;
+  _rec.fdew = rmk.fdew;
+}
+#endif
 
-  if (c != nullptr)
-  {
 #ifndef NO_STD
-        _layers.push_back(c);
+std::shared_ptr<Metar>
 #else
-        _layers[_num_layers++] = c;
+Metar *
 #endif
-  }
+Metar::Create(const char *metar_str, size_t len, parse_mode mode,
+              unsigned int *predicate_calls)
+{
+#ifndef NO_STD
+  MetarRecord rec;
+  SkyOverflow overflow;
+  decode(metar_str, len, rec, mode, DEFAULT, predicate_calls, overflow);
+
+  // the sky is sized from the decoded counts and shares the report's
+  // heap block
+  return StandaloneMetarImpl::Create(rec, overflow);
+#else
+  return new MetarImpl(metar_str, len, mode, predicate_calls);
 #endif
 }
 
-void MetarImpl::parse_vert_vis(const char *str)
+#ifndef NO_STD
+std::shared_ptr<Metar>
+Metar::Create(const char *metar_str, size_t len,
+              const std::shared_ptr<Arena>& arena, parse_mode mode)
 {
-  _vert_vis = atoi(str + 2) * 100;
+  MetarImpl *metar =
+      arena->New<MetarImpl>(metar_str, len, mode, nullptr, *arena);
+  metar->Own(arena);
+
+  return std::shared_ptr<Metar>(arena, metar);
 }
+#endif
 
-void MetarImpl::parse_temp(const char *str)
+#ifndef NO_STD
+std::shared_ptr<MetarParser> MetarParser::Create()
 {
-  char val[4];
+  return make_shared<MetarParserImpl>();
+}
 
-  const char *p = strstr(str, "/");
-  strncpy(val, str, p - str);
+std::shared_ptr<Metar> Metar::CreateLazy(const char *metar_str, size_t len)
+{
+  auto metar = make_shared<LazyMetarImpl>(metar_str, len);
+  metar->Own(metar);
+  return metar;
+}
+#endif
 
-  val[p - str] = '\0';
-  _temp = temp(val);
+#ifndef NO_STD
+std::shared_ptr<Metar>
+#else
+Metar *
+#endif
+Metar::Create(const char *metar_str, size_t len)
+{
+  return Create(metar_str, len, parse_mode::SEQUENTIAL);
+}
 
-  if (*(p + 1) != '\0')
-  {
-    strcpy(val, p + 1);
-    _dew = temp(val);
-  }
+#ifndef NO_STD
+std::shared_ptr<Metar>
+#else
+Metar *
+#endif
+Metar::Create(const char *metar_str)
+{
+  return Create(metar_str, strlen(metar_str));
 }
 
-void MetarImpl::parse_alt(const char *str)
+#ifndef NO_STD
+std::shared_ptr<Metar>
+#else
+Metar *
+#endif
+Metar::Create(char *metar_str)
 {
-  int val = atoi(str + 1);
-  if (str[0] == 'Q')
-    _altimeterQ = val;
-  else
-    _altimeterA = static_cast<double>(val) / 100.0;
+  return Create(static_cast<const char *>(metar_str), strlen(metar_str));
 }
 
-void MetarImpl::parse_phenom(const char *str)
+bool Metar::Decode(const char *metar_str, size_t len, MetarRecord& rec,
+                   parse_mode mode, uint32_t options,
+                   unsigned int *predicate_calls)
 {
-#ifndef NO_PHENOM
+  RecordHandler handler(rec, options);
 
-  auto p = Phenom::Create(str, _tempo);
+  return EventDecoder::Decode(metar_str, len, handler, mode,
+                              predicate_calls, options);
+}
 
-  if (p != nullptr)
+size_t Metar::DecodeBatch(const MetarText *reports, size_t n,
+                          MetarRecord *out, bool *ok, parse_mode mode,
+                          uint32_t options)
+{
+  size_t decoded = 0;
+  for (size_t i = 0 ; i < n ; i++)
   {
+    bool result = Decode(reports[i].str, reports[i].len, out[i], mode,
+                         options);
+    if (ok)
+    {
+      ok[i] = result;
+    }
+
+    if (result)
+    {
+      decoded++;
+    }
+  }
+
+  return decoded;
+}
+
+void MetarRecord::Clear()
+{
+  message_type = Metar::message_type::undefined;
+  icao[0] = '\0';
+  day = INTEGER_UNDEFINED;
+  hour = INTEGER_UNDEFINED;
+  minute = INTEGER_UNDEFINED;
+  wind_dir = INTEGER_UNDEFINED;
+  wind_spd = INTEGER_UNDEFINED;
+  gust = INTEGER_UNDEFINED;
+  wind_speed_units = Metar::speed_units::undefined;
+  min_wind_dir = INTEGER_UNDEFINED;
+  max_wind_dir = INTEGER_UNDEFINED;
+  vrb = false;
+  vis = INTEGER_UNDEFINED;
+  vis_units = Metar::distance_units::undefined;
+  vis_lt = false;
+  cavok = false;
+  vert_vis = INTEGER_UNDEFINED;
+  temp = INTEGER_UNDEFINED;
+  dew = INTEGER_UNDEFINED;
+  altimeterA = INTEGER_UNDEFINED;
+  altimeterQ = INTEGER_UNDEFINED;
+  slp = INTEGER_UNDEFINED;
+  ftemp = INTEGER_UNDEFINED;
+  fdew = INTEGER_UNDEFINED;
+  wind_spd_cms = INTEGER_UNDEFINED;
+  gust_cms = INTEGER_UNDEFINED;
+  vis_m = INTEGER_UNDEFINED;
+  pressure_dhpa = INTEGER_UNDEFINED;
+  temp_dc = INTEGER_UNDEFINED;
+  dew_dc = INTEGER_UNDEFINED;
+  truncated = false;
+#ifndef NO_CLOUDS
+  num_layers = 0;
+#endif
+#ifndef NO_PHENOM
+  num_phenomena = 0;
+#endif
+}
+
 #ifndef NO_STD
-    _phenomena.push_back(p);
+MetarImpl::MetarImpl(const char *metar_str, size_t len, parse_mode mode,
+                     unsigned int *predicate_calls, Arena& arena)
 #else
-    _phenomena[_num_phenomena++] = p;
+MetarImpl::MetarImpl(const char *metar_str, size_t len, parse_mode mode,
+                     unsigned int *predicate_calls)
 #endif
-  }
+{
+#ifndef NO_STD
+  SkyOverflow overflow;
+  decode(metar_str, len, _rec, mode, DEFAULT, predicate_calls, overflow);
+  create_sky(arena, overflow);
+#else
+  Decode(metar_str, len, _rec, mode, DEFAULT, predicate_calls);
+  create_sky();
 #endif
 }
 
-void MetarImpl::parse_slp(const char *str)
+#ifndef NO_STD
+void MetarImpl::create_sky(Arena& arena, const SkyOverflow& overflow)
 {
-  _slp = (atof(str + 3) / 10.0) + 1000.0;
+#ifndef NO_CLOUDS
+  _num_layers = _rec.num_layers + overflow.layers.size();
+  _all_layers = _rec.layers;
+  if (!overflow.layers.empty())
+  {
+    CloudLayer *all = static_cast<CloudLayer *>(
+        arena.Allocate(_num_layers * sizeof(CloudLayer),
+                       alignof(CloudLayer)));
+    uninitialized_copy(_rec.layers, _rec.layers + _rec.num_layers, all);
+    uninitialized_copy(overflow.layers.begin(), overflow.layers.end(),
+                       all + _rec.num_layers);
+    _all_layers = all;
+  }
+
+  if (_num_layers)
+  {
+    _layers = static_cast<Clouds **>(
+        arena.Allocate(_num_layers * sizeof(Clouds *), alignof(Clouds *)));
+  }
+
+  for (unsigned int i = 0 ; i < _num_layers ; i++)
+  {
+    _layers[i] = Clouds::Create(_all_layers[i], arena);
+  }
+#endif
+
+#ifndef NO_PHENOM
+  _num_phenomena = _rec.num_phenomena + overflow.phenomena.size();
+  if (_num_phenomena)
+  {
+    _phenomena = static_cast<Phenom **>(
+        arena.Allocate(_num_phenomena * sizeof(Phenom *),
+                       alignof(Phenom *)));
+  }
+
+  for (unsigned int i = 0 ; i < _num_phenomena ; i++)
+  {
+    _phenomena[i] = Phenom::Create(i < _rec.num_phenomena
+        ? _rec.phenomena[i] : overflow.phenomena[i - _rec.num_phenomena],
+        arena);
+  }
+#endif
 }
 
-void MetarImpl::parse_tempNA(const char *str)
+void MetarImpl::clear_sky()
+{
+#ifndef NO_CLOUDS
+  _num_layers = 0;
+  _all_layers = nullptr;
+  _layers = nullptr;
+#endif
+
+#ifndef NO_PHENOM
+  _num_phenomena = 0;
+  _phenomena = nullptr;
+#endif
+}
+#else
+void MetarImpl::create_sky()
 {
-  char val[5];
+#ifndef NO_CLOUDS
+  for (unsigned int i = 0 ; i < _rec.num_layers ; i++)
+  {
+    _layers[i] = Clouds::Create(_rec.layers[i]);
+  }
+#endif
+
+#ifndef NO_PHENOM
+  for (unsigned int i = 0 ; i < _rec.num_phenomena ; i++)
+  {
+    _phenomena[i] = Phenom::Create(_rec.phenomena[i]);
+  }
+#endif
+}
+#endif
 
-  strncpy(val, str + 1, 4);
-  val[4] = '\0';
-  _ftemp = tempNA(val);
+#ifdef NO_STD
+MetarImpl::~MetarImpl()
+{
+#ifndef NO_CLOUDS
+  for (size_t i = 0 ; i < _rec.num_layers ; i++)
+  {
+    delete _layers[i];
+  }
+#endif
 
-  if (strlen(str) > 5)
+#ifndef NO_PHENOM
+  for (size_t i = 0 ; i < _rec.num_phenomena ; i++)
   {
-    strcpy(val, str + 5);
-    _fdew = tempNA(val);
+    delete _phenomena[i];
   }
+#endif
 }
+#endif
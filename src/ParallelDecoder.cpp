@@ -0,0 +1,333 @@
+//
+// Copyright (c) 2018 James A. Chappell (rlrrlrll@gmail.com)
+//
+// Multi-threaded decoder for buffers holding one METAR per line
+//
+
+#include "ParallelDecoder.h"
+
+#ifndef NO_STD
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+namespace
+{
+  //
+  // A run of whole lines and the block of records decoded from it
+  //
+  struct Chunk
+  {
+    const char *begin;
+    const char *end;
+
+    vector<MetarRecord> records;
+    vector<bool> ok;
+    size_t decoded;
+
+    // index of the first record in the merged output
+    size_t offset;
+  };
+
+  //
+  // Work-stealing task pool.  Every worker owns a deque of task indices,
+  // takes work from its front and, once it runs dry, steals from the back
+  // of the other workers' deques.  The calling thread is worker 0.  Runs
+  // from several threads take turns.
+  //
+  class TaskPool
+  {
+  public:
+    explicit TaskPool(unsigned int num_threads);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void run(size_t num_tasks, const function<void(size_t)>& task);
+
+    unsigned int size() const { return _queues.size(); }
+
+  private:
+    struct Queue
+    {
+      mutex lock;
+      deque<size_t> tasks;
+    };
+
+    bool next(unsigned int self, size_t& task);
+
+    void work(unsigned int self);
+
+    void worker(unsigned int self);
+
+    vector<unique_ptr<Queue>> _queues;
+    vector<thread> _threads;
+
+    // held by the thread whose tasks are running
+    mutex _run;
+
+    mutex _lock;
+    condition_variable _start;
+    condition_variable _done;
+
+    const function<void(size_t)> *_task;
+    unsigned long _generation;
+    unsigned int _busy;
+    bool _stop;
+  };
+
+  TaskPool::TaskPool(unsigned int num_threads)
+    : _task(nullptr)
+    , _generation(0)
+    , _busy(0)
+    , _stop(false)
+  {
+    for (unsigned int i = 0 ; i < num_threads ; i++)
+    {
+      _queues.emplace_back(new Queue);
+    }
+
+    for (unsigned int i = 1 ; i < num_threads ; i++)
+    {
+      _threads.emplace_back(&TaskPool::worker, this, i);
+    }
+  }
+
+  TaskPool::~TaskPool()
+  {
+    {
+      lock_guard<mutex> lk(_lock);
+      _stop = true;
+    }
+    _start.notify_all();
+
+    for (auto& t : _threads)
+    {
+      t.join();
+    }
+  }
+
+  void TaskPool::run(size_t num_tasks, const function<void(size_t)>& task)
+  {
+    lock_guard<mutex> running(_run);
+
+    // contiguous ranges keep neighbouring chunks on the same worker
+    for (size_t i = 0 ; i < num_tasks ; i++)
+    {
+      _queues[(i * size()) / num_tasks]->tasks.push_back(i);
+    }
+
+    {
+      lock_guard<mutex> lk(_lock);
+      _task = &task;
+      _busy = _threads.size();
+      _generation++;
+    }
+    _start.notify_all();
+
+    work(0);
+
+    unique_lock<mutex> lk(_lock);
+    _done.wait(lk, [this] { return _busy == 0; });
+    _task = nullptr;
+  }
+
+  bool TaskPool::next(unsigned int self, size_t& task)
+  {
+    {
+      Queue& own = *_queues[self];
+      lock_guard<mutex> lk(own.lock);
+      if (!own.tasks.empty())
+      {
+        task = own.tasks.front();
+        own.tasks.pop_front();
+        return true;
+      }
+    }
+
+    for (unsigned int i = 1 ; i < size() ; i++)
+    {
+      Queue& victim = *_queues[(self + i) % size()];
+      lock_guard<mutex> lk(victim.lock);
+      if (!victim.tasks.empty())
+      {
+        task = victim.tasks.back();
+        victim.tasks.pop_back();
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void TaskPool::work(unsigned int self)
+  {
+    size_t task;
+    while (next(self, task))
+    {
+      (*_task)(task);
+    }
+  }
+
+  void TaskPool::worker(unsigned int self)
+  {
+    unsigned long seen = 0;
+
+    for (;;)
+    {
+      {
+        unique_lock<mutex> lk(_lock);
+        _start.wait(lk, [this, seen] { return _stop || _generation != seen; });
+        if (_stop) return;
+        seen = _generation;
+      }
+
+      work(self);
+
+      {
+        lock_guard<mutex> lk(_lock);
+        if (--_busy == 0) _done.notify_one();
+      }
+    }
+  }
+
+  void decode_chunk(Chunk& chunk, Metar::parse_mode mode,
+                    uint32_t options)
+  {
+    chunk.decoded = 0;
+
+    const char *p = chunk.begin;
+    while (p < chunk.end)
+    {
+      const char *nl =
+          static_cast<const char *>(memchr(p, '\n', chunk.end - p));
+      const char *eol = nl ? nl : chunk.end;
+
+      size_t len = eol - p;
+      if (len && (p[len - 1] == '\r')) len--;
+
+      if (len)
+      {
+        chunk.records.emplace_back();
+        bool ok = Metar::Decode(p, len, chunk.records.back(), mode,
+                                options);
+        chunk.ok.push_back(ok);
+        if (ok) chunk.decoded++;
+      }
+
+      p = eol + 1;
+    }
+  }
+}
+
+class ParallelDecoderImpl : public ParallelDecoder
+{
+public:
+  ParallelDecoderImpl(unsigned int num_threads, size_t chunk_size)
+    : _pool(num_threads)
+    , _chunk_size(chunk_size ? chunk_size : DEFAULT_CHUNK_SIZE)
+  {
+  }
+
+  virtual ~ParallelDecoderImpl() = default;
+
+  virtual size_t Decode(const char *buffer, size_t len,
+                        vector<MetarRecord>& out, vector<bool> *ok,
+                        Metar::parse_mode mode, uint32_t options);
+
+  virtual unsigned int NumThreads() const { return _pool.size(); }
+
+private:
+  TaskPool _pool;
+  size_t _chunk_size;
+};
+
+shared_ptr<ParallelDecoder>
+ParallelDecoder::Create(unsigned int num_threads, size_t chunk_size)
+{
+  if (num_threads == 0)
+  {
+    num_threads = max(thread::hardware_concurrency(), 1U);
+  }
+
+  return make_shared<ParallelDecoderImpl>(num_threads, chunk_size);
+}
+
+size_t ParallelDecoderImpl::Decode(const char *buffer, size_t len,
+                                   vector<MetarRecord>& out, vector<bool> *ok,
+                                   Metar::parse_mode mode,
+                                   uint32_t options)
+{
+  //
+  // Split into chunks of roughly _chunk_size bytes at line boundaries
+  //
+  vector<Chunk> chunks;
+
+  const char *end = buffer + len;
+  const char *p = buffer;
+  while (p < end)
+  {
+    const char *q = p + min(_chunk_size, static_cast<size_t>(end - p));
+    if (q < end)
+    {
+      const char *nl = static_cast<const char *>(memchr(q, '\n', end - q));
+      q = nl ? nl + 1 : end;
+    }
+
+    chunks.emplace_back();
+    chunks.back().begin = p;
+    chunks.back().end = q;
+
+    p = q;
+  }
+
+  _pool.run(chunks.size(), [&chunks, mode, options](size_t i)
+  {
+    decode_chunk(chunks[i], mode, options);
+  });
+
+  //
+  // Merge the per-chunk blocks in input order
+  //
+  size_t total = 0;
+  size_t decoded = 0;
+  for (auto& chunk : chunks)
+  {
+    chunk.offset = total;
+    total += chunk.records.size();
+    decoded += chunk.decoded;
+  }
+
+  out.resize(total);
+
+  _pool.run(chunks.size(), [&chunks, &out](size_t i)
+  {
+    Chunk& chunk = chunks[i];
+    copy(chunk.records.begin(), chunk.records.end(),
+         out.begin() + chunk.offset);
+    vector<MetarRecord>().swap(chunk.records);
+  });
+
+  if (ok)
+  {
+    ok->clear();
+    ok->reserve(total);
+    for (const auto& chunk : chunks)
+    {
+      ok->insert(ok->end(), chunk.ok.begin(), chunk.ok.end());
+    }
+  }
+
+  return decoded;
+}
+
+#endif
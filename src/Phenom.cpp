@@ -4,6 +4,7 @@
 // METAR weather phenomena decoder
 //
 #include "Phenom.h"
+#include "Arena.h"
 
 #ifndef NO_STD
 #include <cstring>
@@ -18,75 +19,138 @@ using namespace Storage_B::Weather;
 
 namespace
 {
-  const char *BR = "BR";
-  const char *DS = "DS";
-  const char *DU = "DU";
-  const char *DZ = "DZ";
-  const char *FC = "FC";
-  const char *FG = "FG";
-  const char *FU = "FU";
-  const char *GR = "GR";
-  const char *GS = "GS";
-  const char *HZ = "HZ";
-  const char *IC = "IC";
-  const char *PE = "PE";
-  const char *PL = "PL"; 
-  const char *PO = "PO"; 
-  const char *PY = "PY";
-  const char *RA = "RA";
-  const char *SA = "SA";
-  const char *SG = "SG";
-  const char *SH = "SH";
-  const char *SN = "SN";
-  const char *SQ = "SQ";
-  const char *SS = "SS"; 
-  const char *TS = "TS";
-  const char *UP = "UP";
-  const char *VA = "VA";
+  //
+  // Value of a two letter code: a Phenom::phenom, or DESCRIPTOR plus
+  // the bit number of a PhenomGroup descriptor
+  //
+  const unsigned char NOT_A_CODE = 0xFF;
+  const unsigned char DESCRIPTOR = 0x80;
+
+  enum : unsigned char
+  {
+    VICINITY = DESCRIPTOR,  // VC
+    BLOWING,                // BL
+    DRIFTING,               // DR
+    FREEZING,               // FZ
+    PARTIAL,                // PR
+    SHALLOW,                // MI
+    PATCHES,                // BC
+    THUNDERSTORM            // TS
+  };
+
+  static_assert(PhenomGroup::THUNDERSTORM == 1 << (THUNDERSTORM - DESCRIPTOR),
+                "descriptor codes out of step with PhenomGroup");
+
+  constexpr unsigned char code(Phenom::phenom p)
+  {
+    return static_cast<unsigned char>(p);
+  }
+
+  struct Code
+  {
+    char str[3];
+    unsigned char value;
+  };
+
+  //
+  // Perfect hash of every two letter code, see slot()
+  //
+  const Code CODES[64] =
+  {
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "PO", code(Phenom::phenom::DUST_SAND_WHORLS) },
+    { "IC", code(Phenom::phenom::ICE_CRYSTALS) },
+    { "",   NOT_A_CODE },
+    { "DZ", code(Phenom::phenom::DRIZZLE) },
+    { "",   NOT_A_CODE },
+    { "SN", code(Phenom::phenom::SNOW) },
+    { "FG", code(Phenom::phenom::FOG) },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "FZ", FREEZING },
+    { "PR", PARTIAL },
+    { "BL", BLOWING },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "HZ", code(Phenom::phenom::HAZE) },
+    { "SQ", code(Phenom::phenom::SQUALLS) },
+    { "",   NOT_A_CODE },
+    { "UP", code(Phenom::phenom::UNKNOWN_PRECIP) },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "RA", code(Phenom::phenom::RAIN) },
+    { "",   NOT_A_CODE },
+    { "SS", code(Phenom::phenom::SAND_STORM) },
+    { "SA", code(Phenom::phenom::SAND) },
+    { "",   NOT_A_CODE },
+    { "TS", THUNDERSTORM },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "PE", code(Phenom::phenom::ICE_PELLETS) },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "BR", code(Phenom::phenom::MIST) },
+    { "VA", code(Phenom::phenom::VOLCANIC_ASH) },
+    { "MI", SHALLOW },
+    { "PY", code(Phenom::phenom::SPRAY) },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE },
+    { "DR", DRIFTING },
+    { "",   NOT_A_CODE },
+    { "VC", VICINITY },
+    { "",   NOT_A_CODE },
+    { "DS", code(Phenom::phenom::DUST_STORM) },
+    { "",   NOT_A_CODE },
+    { "BC", PATCHES },
+    { "SG", code(Phenom::phenom::SNOW_GRAINS) },
+    { "",   NOT_A_CODE },
+    { "GR", code(Phenom::phenom::HAIL) },
+    { "SH", code(Phenom::phenom::SHOWER) },
+    { "DU", code(Phenom::phenom::DUST) },
+    { "",   NOT_A_CODE },
+    { "GS", code(Phenom::phenom::SMALL_HAIL) },
+    { "",   NOT_A_CODE },
+    { "PL", code(Phenom::phenom::ICE_PELLETS) },
+    { "",   NOT_A_CODE },
+    { "FU", code(Phenom::phenom::SMOKE) },
+    { "FC", code(Phenom::phenom::FUNNEL_CLOUD) },
+    { "",   NOT_A_CODE },
+    { "",   NOT_A_CODE }
+  };
+
+  //
+  // Multiplicative hash of the two characters, chosen to be collision
+  // free over the codes in CODES.  Wraps the same with 16 bit ints.
+  //
+  inline unsigned int slot(char a, char b)
+  {
+    unsigned int key = (static_cast<unsigned char>(a) << 8)
+                     | static_cast<unsigned char>(b);
+    return ((key * 3596U) & 0xFFFFU) >> 10;
+  }
+
+  inline unsigned char lookup(const char *str)
+  {
+    const Code& c = CODES[slot(str[0], str[1])];
+    return ((c.str[0] == str[0]) && (c.str[1] == str[1]))
+        ? c.value : NOT_A_CODE;
+  }
+
+  inline uint32_t intensity_bits(Phenom::intensity i)
+  {
+    return static_cast<uint32_t>(static_cast<int>(i) + 1);
+  }
 }
 
 class PhenomImpl : public Phenom 
 {
 public:
-  PhenomImpl(bool tempo,
-#ifndef NO_STD
-             vector<phenom>& p,
-#else
-             const phenom *p,
-             unsigned int num_phenom,
-#endif
-             intensity i = intensity::NORMAL,
-             bool blowing = false,
-             bool freezing = false,
-             bool drifting = false,
-             bool vicinity = false,
-             bool partial = false,
-             bool shallow = false,
-             bool patches = false,
-             bool ts = false)
-#ifndef NO_STD
-    : _phenoms(p)
-#else
-    : _num_phenom(num_phenom)
-#endif
-    , _intensity(i)
-    , _blowing(blowing)
-    , _freezing(freezing)
-    , _drifting(drifting)
-    , _vicinity(vicinity)
-    , _partial(partial)
-    , _shallow(shallow)
-    , _patches(patches)
-    , _ts(ts)
-    , _tempo(tempo)
-  {
-#ifdef NO_STD
-    for (unsigned int i = 0 ; i < _num_phenom ; i++)
-    {
-      _phenoms[i] = p[i];
-    }
-#endif
-  }
+  PhenomImpl(const PhenomGroup& group) : _group(group) {}
 
   PhenomImpl(const PhenomImpl&) = delete;
   PhenomImpl& operator=(const PhenomImpl&) = delete;
@@ -95,13 +159,12 @@ public:
 
   unsigned int NumPhenom() const 
   { 
-#ifdef NO_STD
-    return _num_phenom;
-#else
-    return _phenoms.size();
-#endif
+    return _group.NumPhenom();
   }
 
+  //
+  // Phenomena in report order, see PhenomGroup::At()
+  //
   virtual phenom
 #ifndef NO_STD
   operator[](typename vector<Phenom>::size_type
@@ -110,355 +173,167 @@ public:
 #endif
                         idx) const
   {
-    if (idx < NumPhenom())
-    {
-      return _phenoms[idx];
-    }
-
-    return phenom::NONE;
+    return _group.At(idx);
   }
 
-  virtual intensity Intensity() const { return _intensity; }
-  virtual bool Blowing() const { return _blowing; }
-  virtual bool Freezing() const { return _freezing; }
-  virtual bool Drifting() const { return _drifting; }
-  virtual bool Vicinity() const { return _vicinity; }
-  virtual bool Partial() const { return _partial; }
-  virtual bool Shallow() const { return _shallow; }
-  virtual bool Patches() const { return _patches; }
-  virtual bool ThunderStorm() const { return _ts; }
-  virtual bool Temporary() const { return _tempo; }
+  virtual intensity Intensity() const { return _group.Intensity(); }
+  virtual bool Blowing() const { return has(PhenomGroup::BLOWING); }
+  virtual bool Freezing() const { return has(PhenomGroup::FREEZING); }
+  virtual bool Drifting() const { return has(PhenomGroup::DRIFTING); }
+  virtual bool Vicinity() const { return has(PhenomGroup::VICINITY); }
+  virtual bool Partial() const { return has(PhenomGroup::PARTIAL); }
+  virtual bool Shallow() const { return has(PhenomGroup::SHALLOW); }
+  virtual bool Patches() const { return has(PhenomGroup::PATCHES); }
+  virtual bool ThunderStorm() const
+  {
+    return has(PhenomGroup::THUNDERSTORM);
+  }
+  virtual bool Temporary() const { return has(PhenomGroup::TEMPORARY); }
 
 private:
+  bool has(uint32_t descriptor) const
+  {
+    return (_group.descriptors & descriptor) != 0;
+  }
+
+  PhenomGroup _group;
+};
+
 #ifndef NO_STD
-  vector<phenom> _phenoms;
+          std::shared_ptr<Phenom>
 #else
-  phenom _phenoms[4];
-  size_t _num_phenom;
+          Phenom *
 #endif
-  intensity _intensity;
-  bool _blowing;
-  bool _freezing;
-  bool _drifting;
-  bool _vicinity;
-  bool _shower;
-  bool _partial;
-  bool _shallow;
-  bool _patches;
-  bool _ts;
-  bool _tempo;
-};
+Phenom::Create(const char *str, bool tempo)
+{
+  return Create(str, strlen(str), tempo);
+}
 
 #ifndef NO_STD
           std::shared_ptr<Phenom>
 #else
           Phenom *
 #endif
-Phenom::Create(const char *str, bool tempo)
+Phenom::Create(const char *str, size_t len, bool tempo)
+{
+  PhenomGroup group;
+
+  if (Decode(str, len, tempo, group))
+  {
+    return Create(group);
+  }
+
+  return nullptr;
+}
+
+#ifndef NO_STD
+          std::shared_ptr<Phenom>
+#else
+          Phenom *
+#endif
+Phenom::Create(const PhenomGroup& group)
 {
 #ifndef NO_STD
-  vector<Phenom::phenom> p;
+  return make_shared<PhenomImpl>(group);
 #else
-  unsigned int idx = 0;
-  Phenom::phenom p[4];
+  return new PhenomImpl(group);
 #endif
-  Phenom::intensity inten = Phenom::intensity::NORMAL;
-  bool blowing = false;
-  bool freezing = false;
-  bool drifting = false;
-  bool vicinity = false;
-  bool partial = false;
-  bool shallow = false;
-  bool patches = false;
-  bool ts = false;
+}
+
+#ifndef NO_STD
+Phenom *Phenom::Create(const PhenomGroup& group, Arena& arena)
+{
+  return arena.New<PhenomImpl>(group);
+}
+
+size_t Phenom::ArenaSize()
+{
+  return Arena::Footprint(sizeof(PhenomImpl));
+}
+#endif
+
+bool Phenom::Decode(const char *str, size_t len, bool tempo,
+                    PhenomGroup& group)
+{
+  group.phenoms = 0;
+  group.descriptors = tempo ? static_cast<uint32_t>(PhenomGroup::TEMPORARY)
+                            : static_cast<uint32_t>(0);
+  group.intensity = intensity_bits(Phenom::intensity::NORMAL);
+  group.order = 0;
+
+  if (len == 0)
+  {
+    return false;
+  }
 
   if (!isalpha(str[0]))
   {
     switch(str[0])
     {
       case '-':
-        inten =  Phenom::intensity::LIGHT;
+        group.intensity = intensity_bits(Phenom::intensity::LIGHT);
         break;
 
       case '+':
-        inten =  Phenom::intensity::HEAVY;
+        group.intensity = intensity_bits(Phenom::intensity::HEAVY);
         break;
 
       default:
-        return nullptr;
+        return false;
     }
     str++;
+    len--;
   }
 
-  if (!isalpha(str[0]) || !isalpha(str[1]))
+  if ((len < 2) || !isalpha(str[0]) || !isalpha(str[1]))
   {
-    return nullptr;
+    return false;
   }
   
-  while (strlen(str) > 1)
+  for ( ; len > 1 ; str += 2, len -= 2)
   {
-    if (!strncmp(str, "VC", 2))
-    {
-      vicinity = true;
-    }
-    else if (!strncmp(str, "BL", 2))
-    {
-      blowing = true;
-    }
-    else if (!strncmp(str, "DR", 2))
-    {
-      drifting = true;
-    }
-    else if (!strncmp(str, "FZ", 2))
-    {
-      freezing = true;
-    }
-    else if (!strncmp(str, "PR", 2))
-    {
-      partial = true;
-    }
-    else if (!strncmp(str, "MI", 2))
-    {
-      shallow = true;
-    }
-    else if (!strncmp(str, "BC", 2))
-    {
-      patches = true;
-    }
-    else if (!strncmp(str, TS, 2))
-    {
-      ts = true;
-    }
-    else if (!strncmp(str, SH, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::SHOWER);
-#else
-      p[idx++] = Phenom::phenom::SHOWER;
-#endif
-    }
-    else if (!strncmp(str, BR, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::MIST);
-#else
-      p[idx++] = Phenom::phenom::MIST;
-#endif
-    }
-    else if (!strncmp(str, DS, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::DUST_STORM);
-#else
-      p[idx++] = Phenom::phenom::DUST_STORM;
-#endif
-    }
-    else if (!strncmp(str, DU, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::DUST);
-#else
-      p[idx++] = Phenom::phenom::DUST;
-#endif
-    }
-    else if (!strncmp(str, DZ, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::DRIZZLE);
-#else
-      p[idx++] = Phenom::phenom::DRIZZLE;
-#endif
-    }
-    else if (!strncmp(str, FC, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::FUNNEL_CLOUD);
-#else
-      p[idx++] = Phenom::phenom::FUNNEL_CLOUD;
-#endif
-    }
-    else if (!strncmp(str, FG, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::FOG);
-#else
-      p[idx++] = Phenom::phenom::FOG;
-#endif
-    }
-    else if (!strncmp(str, FU, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::SMOKE);
-#else
-      p[idx++] = Phenom::phenom::SMOKE;
-#endif
-    }
-    else if (!strncmp(str, GR, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::HAIL);
-#else
-      p[idx++] = Phenom::phenom::HAIL;
-#endif
-    }
-    else if (!strncmp(str, GS, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::SMALL_HAIL);
-#else
-      p[idx++] = Phenom::phenom::SMALL_HAIL;
-#endif
-    }
-    else if (!strncmp(str, HZ, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::HAZE);
-#else
-      p[idx++] = Phenom::phenom::HAZE;
-#endif
-    }
-    else if (!strncmp(str, IC, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::ICE_CRYSTALS);
-#else
-      p[idx++] = Phenom::phenom::ICE_CRYSTALS;
-#endif
-    }
-    else if (!strncmp(str, PE, 2) || !strncmp(str, PL, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::ICE_PELLETS);
-#else
-      p[idx++] = Phenom::phenom::ICE_PELLETS;
-#endif
-    }
-    else if (!strncmp(str, PO, 2)) 
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::DUST_SAND_WHORLS);
-#else
-      p[idx++] = Phenom::phenom::DUST_SAND_WHORLS;
-#endif
-    }
-    else if (!strncmp(str, PY, 2)) 
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::SPRAY);
-#else
-      p[idx++] = Phenom::phenom::SPRAY;
-#endif
-    }
-    else if (!strncmp(str, RA, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::RAIN);
-#else
-      p[idx++] = Phenom::phenom::RAIN;
-#endif
-    }
-    else if (!strncmp(str, SA, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::SAND);
-#else
-      p[idx++] = Phenom::phenom::SAND;
-#endif
-    }
-    else if (!strncmp(str, SG, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::SNOW_GRAINS);
-#else
-      p[idx++] = Phenom::phenom::SNOW_GRAINS;
-#endif
-    }
-    else if (!strncmp(str, SN, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::SNOW);
-#else
-      p[idx++] = Phenom::phenom::SNOW;
-#endif
-    }
-    else if (!strncmp(str, SQ, 2))
-    {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::SQUALLS);
-#else
-      p[idx++] = Phenom::phenom::SQUALLS;
-#endif
-    }
-    else if (!strncmp(str, SS, 2)) 
+    unsigned char value = lookup(str);
+
+    if (value == NOT_A_CODE)
     {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::SAND_STORM);
-#else
-      p[idx++] = Phenom::phenom::SAND_STORM;
-#endif
+      continue;
     }
-    else if (!strncmp(str, UP, 2))
+
+    if (value & DESCRIPTOR)
     {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::UNKNOWN_PRECIP);
-#else
-      p[idx++] = Phenom::phenom::UNKNOWN_PRECIP;
-#endif
+      group.descriptors |= 1U << (value - DESCRIPTOR);
     }
-    else if (!strncmp(str, VA, 2))
+    else
     {
-#ifndef NO_STD
-      p.push_back(Phenom::phenom::VOLCANIC_ASH);
-#else
-      p[idx++] = Phenom::phenom::VOLCANIC_ASH;
-#endif
+      uint32_t bit = PhenomGroup::Mask(static_cast<Phenom::phenom>(value));
+      if (!(group.phenoms & bit))
+      {
+        unsigned int n = group.NumPhenom();
+        if (n < PhenomGroup::ORDERED)
+        {
+          group.order |= static_cast<uint32_t>(value) << (5 * n);
+        }
+        group.phenoms |= bit;
+      }
     }
-    str += 2;
   }
 
-  if (
-#ifndef NO_STD
-      (p.size() > 0)
-#else
-      (idx > 0)
-#endif
-      || blowing
-      || freezing
-      || drifting
-      || vicinity
-      || partial
-      || shallow
-      || patches
-      || ts
-      )
+  return group.phenoms || (group.descriptors & ~PhenomGroup::TEMPORARY);
+}
+
+size_t Phenom::Match(const PhenomGroup *groups, size_t n, uint32_t phenoms,
+                     uint32_t descriptors, bool *match)
+{
+  size_t count = 0;
+  for (size_t i = 0 ; i < n ; i++)
   {
-#ifndef NO_STD
-    return make_shared<PhenomImpl>(tempo,
-                                   p,
-                                   inten,
-                                   blowing,
-                                   freezing,
-                                   drifting,
-                                   vicinity,
-                                   partial,
-                                   shallow,
-                                   patches,
-                                   ts);
-#else
-    return new PhenomImpl(tempo,
-                          p,
-                          idx,
-                          inten,
-                          blowing,
-                          freezing,
-                          drifting,
-                          vicinity,
-                          partial,
-                          shallow,
-                          patches,
-                          ts);
-#endif
+    bool m = groups[i].Matches(phenoms, descriptors);
+    if (match)
+    {
+      match[i] = m;
+    }
+    count += m;
   }
 
-  return nullptr;
+  return count;
 }
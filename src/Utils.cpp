@@ -7,12 +7,22 @@
 
 #ifndef NO_STD
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #else
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 #endif
 
 #include <Convert.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace Storage_B::Weather;
 
 double Utils::Humidity(double t, double td)
@@ -70,3 +80,427 @@ double Utils::HeatIndex(double temp, double humidity, bool celsius_flg)
 
   return temp;
 }
+
+namespace
+{
+#if defined(__SIZEOF_DOUBLE__) && (__SIZEOF_DOUBLE__ == 8)
+  //
+  // With 64 bit IEEE doubles the exponent is split off and put back
+  // with integer operations rather than floor(), ldexp() and frexp()
+  //
+  inline double from_bits(uint64_t u)
+  {
+    double d;
+    memcpy(&d, &u, sizeof(d));
+    return d;
+  }
+
+  inline uint64_t to_bits(double d)
+  {
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    return u;
+  }
+
+  //
+  // 2^y: 2^r, |r| <= 0.5, from a degree 3 minimax polynomial (relative
+  // error 7.5e-5), scaled by 2^round(y)
+  //
+  inline double exp2_fast(double y)
+  {
+    y = fmin(fmax(y, -1000.0), 1000.0);
+
+    // adding then subtracting 1.5 * 2^52 rounds to the nearest integer
+    double n = (y + 6755399441055744.0) - 6755399441055744.0;
+    double r = y - n;
+
+    double p = ((0.05517166909261175 * r + 0.2426111222237535) * r
+                + 0.6932609854542457) * r + 0.9999280735351597;
+
+    return p * from_bits(static_cast<uint64_t>(static_cast<int64_t>(n) + 1023)
+                         << 52);
+  }
+
+  //
+  // log2(x) for positive normal x: x = m * 2^e, 1 <= m < 2, log2(m)
+  // from a degree 3 minimax polynomial (absolute error 6.4e-4)
+  //
+  inline double log2_fast(double x)
+  {
+    uint64_t u = to_bits(x);
+    int e = static_cast<int>(u >> 52) - 1023;
+    double m = from_bits((u & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL);
+
+    return (((0.15824870384630607 * m - 1.0518750276548572) * m
+             + 3.047884156040429) * m - 2.1536207150266264) + e;
+  }
+#else
+  double exp2_fast(double y)
+  {
+    double n = floor(y + 0.5);
+    double r = y - n;
+
+    double p = ((0.05517166909261175 * r + 0.2426111222237535) * r
+                + 0.6932609854542457) * r + 0.9999280735351597;
+
+    return ldexp(p, static_cast<int>(n));
+  }
+
+  double log2_fast(double x)
+  {
+    int e;
+    double m = 2.0 * frexp(x, &e);
+
+    return (((0.15824870384630607 * m - 1.0518750276548572) * m
+             + 3.047884156040429) * m - 2.1536207150266264) + e - 1;
+  }
+#endif
+}
+
+double Utils::HumidityFast(double t, double td)
+{
+  // exp(a(td)) / exp(a(t)) as one power of two
+  double x = (17.625 * 243.04 * (td - t)) / ((243.04 + td) * (243.04 + t));
+
+  return 100.0 * exp2_fast(x * 1.4426950408889634);
+}
+
+double Utils::WindChillFast(double temp, double wind_speed)
+{
+  double twc(temp);
+
+  if ((wind_speed > 4.8) && (temp <= 10.0))
+  {
+    double v16(exp2_fast(0.16 * log2_fast(wind_speed)));
+    twc = 13.12 + (0.6215 * temp) - (11.37 * v16)
+                            + (0.3965 * temp * v16);
+  }
+
+  return twc;
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+namespace
+{
+  //
+  // Just enough of a vector type for the kernels below.  Arithmetic
+  // uses the compiler's vector operators, comparisons return all ones
+  // or all zero lanes for select().
+  //
+#if defined(__AVX2__)
+  typedef __m256d vec;
+  const size_t LANES = 4;
+
+  inline vec load(const double *p) { return _mm256_loadu_pd(p); }
+  inline void store(double *p, vec v) { _mm256_storeu_pd(p, v); }
+  inline vec set1(double d) { return _mm256_set1_pd(d); }
+
+  inline vec vmin(vec a, vec b) { return _mm256_min_pd(a, b); }
+  inline vec vmax(vec a, vec b) { return _mm256_max_pd(a, b); }
+  inline vec vsqrt(vec a) { return _mm256_sqrt_pd(a); }
+
+  inline vec gt(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+  inline vec ge(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+  inline vec vand(vec a, vec b) { return _mm256_and_pd(a, b); }
+  inline vec vandnot(vec a, vec b) { return _mm256_andnot_pd(a, b); }
+  inline vec vor(vec a, vec b) { return _mm256_or_pd(a, b); }
+  inline vec select(vec mask, vec a, vec b)
+  {
+    return _mm256_blendv_pd(b, a, mask);
+  }
+  inline bool none(vec mask) { return _mm256_movemask_pd(mask) == 0; }
+
+  inline vec bits(uint64_t u)
+  {
+    return _mm256_castsi256_pd(_mm256_set1_epi64x(u));
+  }
+  inline vec add64(vec a, vec b)
+  {
+    return _mm256_castsi256_pd(_mm256_add_epi64(_mm256_castpd_si256(a),
+                                                 _mm256_castpd_si256(b)));
+  }
+  inline vec shl52(vec a)
+  {
+    return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(a), 52));
+  }
+  inline vec shr52(vec a)
+  {
+    return _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_castpd_si256(a), 52));
+  }
+#else
+  typedef __m128d vec;
+  const size_t LANES = 2;
+
+  inline vec load(const double *p) { return _mm_loadu_pd(p); }
+  inline void store(double *p, vec v) { _mm_storeu_pd(p, v); }
+  inline vec set1(double d) { return _mm_set1_pd(d); }
+
+  inline vec vmin(vec a, vec b) { return _mm_min_pd(a, b); }
+  inline vec vmax(vec a, vec b) { return _mm_max_pd(a, b); }
+  inline vec vsqrt(vec a) { return _mm_sqrt_pd(a); }
+
+  inline vec gt(vec a, vec b) { return _mm_cmpgt_pd(a, b); }
+  inline vec ge(vec a, vec b) { return _mm_cmpge_pd(a, b); }
+  inline vec vand(vec a, vec b) { return _mm_and_pd(a, b); }
+  inline vec vandnot(vec a, vec b) { return _mm_andnot_pd(a, b); }
+  inline vec vor(vec a, vec b) { return _mm_or_pd(a, b); }
+  inline vec select(vec mask, vec a, vec b)
+  {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+  }
+  inline bool none(vec mask) { return _mm_movemask_pd(mask) == 0; }
+
+  inline vec bits(uint64_t u)
+  {
+    return _mm_castsi128_pd(_mm_set1_epi64x(u));
+  }
+  inline vec add64(vec a, vec b)
+  {
+    return _mm_castsi128_pd(_mm_add_epi64(_mm_castpd_si128(a),
+                                          _mm_castpd_si128(b)));
+  }
+  inline vec shl52(vec a)
+  {
+    return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(a), 52));
+  }
+  inline vec shr52(vec a)
+  {
+    return _mm_castsi128_pd(_mm_srli_epi64(_mm_castpd_si128(a), 52));
+  }
+#endif
+
+  const double LN2_HI = 6.93147180369123816490e-01;
+  const double LN2_LO = 1.90821492927058770002e-10;
+
+  // adding then subtracting 1.5 * 2^52 rounds to the nearest integer,
+  // which is left in the low bits of the sum
+  const double ROUND = 6755399441055744.0;
+
+  //
+  // exp(x) = 2^k * exp(r), |r| <= ln(2) / 2, with exp(r) from its
+  // Taylor series to r^11 (relative error below 1e-14).  x is clamped
+  // to the range of normal doubles.
+  //
+  inline vec vexp(vec x)
+  {
+    x = vmin(vmax(x, set1(-708.0)), set1(709.0));
+
+    vec t = x * set1(1.4426950408889634) + set1(ROUND);
+    vec k = t - set1(ROUND);
+    vec r = x - k * set1(LN2_HI) - k * set1(LN2_LO);
+
+    vec p = set1(1.0 / 39916800.0);
+    p = p * r + set1(1.0 / 3628800.0);
+    p = p * r + set1(1.0 / 362880.0);
+    p = p * r + set1(1.0 / 40320.0);
+    p = p * r + set1(1.0 / 5040.0);
+    p = p * r + set1(1.0 / 720.0);
+    p = p * r + set1(1.0 / 120.0);
+    p = p * r + set1(1.0 / 24.0);
+    p = p * r + set1(1.0 / 6.0);
+    p = p * r + set1(0.5);
+    p = p * r + set1(1.0);
+    p = p * r + set1(1.0);
+
+    // 2^k built from the biased exponent k + 1023
+    vec scale = shl52(add64(t, bits(1023)));
+
+    return p * scale;
+  }
+
+  //
+  // log(x) for positive normal x: x = m * 2^e, sqrt(1/2) <= m < sqrt(2),
+  // log(m) = 2 atanh(s), s = (m - 1) / (m + 1), |s| < 0.172, from its
+  // series to s^17 (error below 1e-16)
+  //
+  inline vec vlog(vec x)
+  {
+    vec m = vor(vand(x, bits(0x000FFFFFFFFFFFFFULL)), set1(1.0));
+    vec e = vor(shr52(x), bits(0x4330000000000000ULL))
+          - set1(4503599627370496.0 + 1023.0);
+
+    vec big = gt(m, set1(1.4142135623730951));
+    m = select(big, m * set1(0.5), m);
+    e = select(big, e + set1(1.0), e);
+
+    vec s = (m - set1(1.0)) / (m + set1(1.0));
+    vec z = s * s;
+
+    vec p = set1(1.0 / 17.0);
+    p = p * z + set1(1.0 / 15.0);
+    p = p * z + set1(1.0 / 13.0);
+    p = p * z + set1(1.0 / 11.0);
+    p = p * z + set1(1.0 / 9.0);
+    p = p * z + set1(1.0 / 7.0);
+    p = p * z + set1(1.0 / 5.0);
+    p = p * z + set1(1.0 / 3.0);
+    p = p * z + set1(1.0);
+
+    return e * set1(LN2_HI) + (set1(2.0) * s * p + e * set1(LN2_LO));
+  }
+
+  inline vec humidity(vec t, vec td)
+  {
+    vec a = set1(17.625) * td / (set1(243.04) + td);
+    vec b = set1(17.625) * t / (set1(243.04) + t);
+
+    // exp(a) / exp(b) as one exp()
+    return set1(100.0) * vexp(a - b);
+  }
+
+#if defined(__AVX2__)
+  //
+  // With two lanes the exp() and log() these need cost more than the
+  // scalar versions save, so below AVX2 WindChill and HeatIndex use the
+  // scalar loop
+  //
+  inline vec wind_chill(vec temp, vec wind_speed)
+  {
+    vec chill = vand(gt(wind_speed, set1(4.8)), ge(set1(10.0), temp));
+    if (none(chill)) return temp;
+
+    // v^0.16, only used where wind_speed > 4.8
+    vec v16 = vexp(set1(0.16) * vlog(vmax(wind_speed, set1(1.0))));
+    vec twc = set1(13.12) + (set1(0.6215) * temp) - (set1(11.37) * v16)
+                          + (set1(0.3965) * temp * v16);
+
+    return select(chill, twc, temp);
+  }
+
+  inline vec heat_index(vec temp, vec humidity, bool celsius_flg)
+  {
+    vec t = celsius_flg ? (temp * set1(1.8)) + set1(32.0) : temp;
+
+    vec hot = ge(t, set1(80.0));
+    if (none(hot)) return temp;
+
+    vec dry = vand(vand(gt(set1(13.0), humidity), gt(t, set1(80.0))),
+                   gt(set1(112.0), t));
+    vec humid = vandnot(dry,
+                        vand(vand(gt(humidity, set1(85.0)),
+                                  ge(t, set1(80.0))),
+                             gt(set1(87.0), t)));
+
+    vec dt = vandnot(bits(0x8000000000000000ULL), t - set1(95.0));
+    vec adj_dry = set1(0.0) - (((set1(13.0) - humidity) / set1(4.0))
+        * vsqrt(vmax((set1(17.0) - dt) / set1(17.0), set1(0.0))));
+    vec adj_humid = ((humidity - set1(85.0)) / set1(10.0))
+                  * ((set1(87.0) - t) / set1(5.0));
+    vec adj = select(dry, adj_dry, select(humid, adj_humid, set1(0.0)));
+
+    vec h = humidity;
+    vec thi = set1(-42.379)
+      + set1(2.04901523) * t
+      + set1(10.14333127) * h
+      - set1(0.22475541) * t * h
+      - set1(0.00683783) * t * t
+      - set1(0.05481717) * h * h
+      + set1(0.00122874) * t * t * h
+      + set1(0.00085282) * t * h * h
+      - set1(0.00000199) * t * t * h * h;
+
+    thi = thi + adj;
+    if (celsius_flg) thi = (thi - set1(32.0)) / set1(1.8);
+
+    return select(hot, thi, temp);
+  }
+#endif
+
+  //
+  // Apply kernel to whole vectors, then to the tail copied into a
+  // padded vector so every element gets the same approximation
+  //
+  template <typename Kernel>
+  void apply(const double *a, const double *b, double *out, size_t n,
+             Kernel kernel)
+  {
+    size_t i = 0;
+    for ( ; i + LANES <= n ; i += LANES)
+    {
+      store(out + i, kernel(load(a + i), load(b + i)));
+    }
+
+    if (i < n)
+    {
+      double ta[LANES] = { 0 };
+      double tb[LANES] = { 0 };
+      double tout[LANES];
+      for (size_t j = i ; j < n ; j++)
+      {
+        ta[j - i] = a[j];
+        tb[j - i] = b[j];
+      }
+
+      store(tout, kernel(load(ta), load(tb)));
+
+      for (size_t j = i ; j < n ; j++)
+      {
+        out[j] = tout[j - i];
+      }
+    }
+  }
+}
+
+void Utils::Humidity(const double *t, const double *td, double *out,
+                     size_t n)
+{
+  apply(t, td, out, n, [](vec a, vec b) { return humidity(a, b); });
+}
+
+#if defined(__AVX2__)
+
+void Utils::WindChill(const double *temp, const double *wind_speed,
+                      double *out, size_t n)
+{
+  apply(temp, wind_speed, out, n, [](vec a, vec b)
+  {
+    return wind_chill(a, b);
+  });
+}
+
+void Utils::HeatIndex(const double *temp, const double *humidity,
+                      double *out, size_t n, bool celsius_flg)
+{
+  apply(temp, humidity, out, n, [celsius_flg](vec t, vec h)
+  {
+    return heat_index(t, h, celsius_flg);
+  });
+}
+
+#endif
+
+#else
+
+void Utils::Humidity(const double *t, const double *td, double *out,
+                     size_t n)
+{
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    out[i] = Humidity(t[i], td[i]);
+  }
+}
+
+#endif
+
+#if !defined(__AVX2__)
+
+void Utils::WindChill(const double *temp, const double *wind_speed,
+                      double *out, size_t n)
+{
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    out[i] = WindChill(temp[i], wind_speed[i]);
+  }
+}
+
+void Utils::HeatIndex(const double *temp, const double *humidity,
+                      double *out, size_t n, bool celsius_flg)
+{
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    out[i] = HeatIndex(temp[i], humidity[i], celsius_flg);
+  }
+}
+
+#endif
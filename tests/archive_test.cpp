@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Archive tests
+//
+
+#include "Archive.h"
+
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#define BOOST_TEST_MODULE METAR
+#include <boost/test/included/unit_test.hpp>
+
+using namespace Storage_B::Weather;
+
+namespace
+{
+  //
+  // Temporary file removed when it goes out of scope
+  //
+  class TempFile
+  {
+  public:
+    explicit TempFile(const std::string& contents)
+    {
+      strcpy(_path, "/tmp/archive_testXXXXXX");
+      int fd = mkstemp(_path);
+      if (fd >= 0)
+      {
+        if (write(fd, contents.data(), contents.size()) < 0) _path[0] = '\0';
+        close(fd);
+      }
+    }
+
+    ~TempFile() { unlink(_path); }
+
+    const char *Path() const { return _path; }
+
+  private:
+    char _path[32];
+  };
+
+  const char *STL =
+    "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029 RMK AO2 SLP260 T00940061";
+  const char *LBBG =
+    "METAR LBBG 041600Z 12012MPS 090V150 1400 +SN BKN022 OVC050 M04/M07 Q1020";
+  const char *HLN = "KHLN 041610Z";
+}
+
+BOOST_AUTO_TEST_CASE(archive_open_failure)
+{
+  BOOST_CHECK(!Archive::Open("/nonexistent/metar.txt"));
+}
+
+BOOST_AUTO_TEST_CASE(archive_empty)
+{
+  TempFile file("");
+
+  auto archive = Archive::Open(file.Path());
+  BOOST_REQUIRE(archive);
+  BOOST_CHECK(archive->Size() == 0);
+  BOOST_CHECK(archive->NumLines() == 0);
+
+  std::vector<MetarRecord> out(3);
+  BOOST_CHECK(archive->Decode(out) == 0);
+  BOOST_CHECK(out.empty());
+}
+
+BOOST_AUTO_TEST_CASE(archive_decode)
+{
+  std::string contents = std::string(STL) + "\r\n\n" + LBBG + "\n"
+                       + "2018/11/23 17:51\n" + HLN;
+  TempFile file(contents);
+
+  auto archive = Archive::Open(file.Path());
+  BOOST_REQUIRE(archive);
+  BOOST_CHECK(archive->Size() == contents.size());
+  BOOST_CHECK(memcmp(archive->Data(), contents.data(), contents.size()) == 0);
+  BOOST_CHECK(archive->NumLines() == 5);
+
+  std::vector<MetarRecord> out;
+  std::vector<bool> ok;
+  BOOST_CHECK(archive->Decode(out, &ok) == 3);
+
+  BOOST_REQUIRE(out.size() == 4);
+  BOOST_REQUIRE(ok.size() == 4);
+
+  BOOST_CHECK(ok[0]);
+  BOOST_CHECK(strcmp(out[0].icao, "KSTL") == 0);
+  BOOST_CHECK(out[0].DewPointNA() == 6.1);
+
+  BOOST_CHECK(ok[1]);
+  BOOST_CHECK(strcmp(out[1].icao, "LBBG") == 0);
+  BOOST_CHECK(out[1].altimeterQ == 1020);
+
+  BOOST_CHECK(!ok[2]);
+
+  BOOST_CHECK(ok[3]);
+  BOOST_CHECK(strcmp(out[3].icao, "KHLN") == 0);
+  BOOST_CHECK(out[3].minute == 10);
+}
+
+BOOST_AUTO_TEST_CASE(archive_handler)
+{
+  // line lengths that straddle the 64 byte scan blocks in every way
+  std::string contents;
+  for (size_t i = 0 ; i < 300 ; i++)
+  {
+    contents += std::string(STL, 12 + i % 64);
+    contents += '\n';
+  }
+  TempFile file(contents);
+
+  auto archive = Archive::Open(file.Path());
+  BOOST_REQUIRE(archive);
+  BOOST_CHECK(archive->NumLines() == 300);
+
+  size_t count = 0;
+  size_t errors = 0;
+  size_t decoded = archive->Decode([&](const MetarRecord& rec, bool ok)
+  {
+    if (!ok || strcmp(rec.icao, "KSTL") || (rec.minute != 51)) errors++;
+    count++;
+  });
+
+  BOOST_CHECK(decoded == 300);
+  BOOST_CHECK(count == 300);
+  BOOST_CHECK(errors == 0);
+}
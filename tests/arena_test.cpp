@@ -0,0 +1,226 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Arena tests
+//
+
+#include "Arena.h"
+#include "Metar.h"
+
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <string>
+
+#define BOOST_TEST_MODULE METAR
+#include <boost/test/included/unit_test.hpp>
+
+using namespace Storage_B::Weather;
+
+//
+// Count every heap allocation made by the library
+//
+static size_t allocations = 0;
+static size_t largest_size = 0;
+
+void *operator new(size_t size)
+{
+  allocations++;
+  if (size > largest_size) largest_size = size;
+  void *p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  free(p);
+}
+
+namespace
+{
+  const char *REPORT =
+    "METAR LBBG 041600Z 12012MPS 090V150 1400 -TSRA +SN BR "
+    "FEW008 SCT012 BKN022 OVC050 M04/M07 Q1020";
+
+  struct Counted
+  {
+    explicit Counted(int& count) : _count(count) { _count++; }
+    ~Counted() { _count--; }
+
+    int& _count;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(arena_allocate)
+{
+  Arena arena(256);
+
+  void *a = arena.Allocate(3, 1);
+  void *b = arena.Allocate(8, 8);
+  BOOST_CHECK(reinterpret_cast<uintptr_t>(b) % 8 == 0);
+  BOOST_CHECK(static_cast<char *>(b) >= static_cast<char *>(a) + 3);
+  BOOST_CHECK(arena.NumBlocks() == 1);
+
+  // larger than a block
+  arena.Allocate(1000, 16);
+  BOOST_CHECK(arena.NumBlocks() == 2);
+
+  arena.Release();
+  BOOST_CHECK(arena.NumBlocks() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(arena_buffer_first)
+{
+  alignas(std::max_align_t) char buffer[128];
+  Arena arena(buffer, sizeof(buffer));
+
+  size_t before = allocations;
+  BOOST_CHECK(arena.Allocate(100, 1) == buffer);
+  BOOST_CHECK(allocations == before);
+  BOOST_CHECK(arena.NumBlocks() == 0);
+
+  arena.Allocate(100, 1);
+  BOOST_CHECK(allocations == before + 1);
+  BOOST_CHECK(arena.NumBlocks() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(arena_reset_buffer)
+{
+  alignas(std::max_align_t) char first[64];
+  alignas(std::max_align_t) char second[256];
+  Arena arena(first, sizeof(first));
+
+  arena.Allocate(100, 1);
+  BOOST_CHECK(arena.NumBlocks() == 1);
+
+  size_t before = allocations;
+  arena.Reset(second, sizeof(second));
+  BOOST_CHECK(arena.NumBlocks() == 0);
+  BOOST_CHECK(arena.Allocate(100, 1) == second);
+  BOOST_CHECK(allocations == before);
+}
+
+BOOST_AUTO_TEST_CASE(metar_sized_from_counts)
+{
+  // the sky buffer follows the report in its block and only has room for
+  // the groups decoded, the other allocation is the shared_ptr control
+  // block
+  size_t before = allocations;
+  largest_size = 0;
+  auto clear = Metar::Create("KSTL 231751Z 27009KT 10SM 09/06 A3029");
+  BOOST_CHECK(allocations == before + 2);
+  size_t clear_size = largest_size;
+
+  before = allocations;
+  largest_size = 0;
+  auto metar = Metar::Create(REPORT);
+  BOOST_CHECK(allocations == before + 2);
+
+  // each object, and an array of pointers to them
+  const size_t align = alignof(std::max_align_t);
+  BOOST_CHECK(largest_size - clear_size ==
+              4 * Clouds::ArenaSize() + 4 * sizeof(Clouds *) + align
+              + 3 * Phenom::ArenaSize() + 3 * sizeof(Phenom *) + align);
+}
+
+BOOST_AUTO_TEST_CASE(arena_destroys_objects)
+{
+  int count = 0;
+  {
+    Arena arena;
+    for (int i = 0 ; i < 10 ; i++)
+    {
+      arena.New<Counted>(count);
+    }
+    BOOST_CHECK(count == 10);
+
+    arena.Release();
+    BOOST_CHECK(count == 0);
+
+    arena.New<Counted>(count);
+    BOOST_CHECK(count == 1);
+  }
+  BOOST_CHECK(count == 0);
+}
+
+BOOST_AUTO_TEST_CASE(metar_allocations)
+{
+  // the report with its sky, and the shared_ptr control block
+  size_t before = allocations;
+  auto metar = Metar::Create(REPORT);
+  BOOST_CHECK(allocations == before + 2);
+
+  BOOST_REQUIRE(metar->NumCloudLayers() == 4);
+  BOOST_REQUIRE(metar->NumPhenomena() == 3);
+
+  before = allocations;
+  BOOST_CHECK(metar->Layer(2)->Cover() == Clouds::cover::BKN);
+  BOOST_CHECK(metar->Layer(3)->Altitude() == 50);
+  BOOST_CHECK(metar->Phenomenon(1)[0] == Phenom::phenom::SNOW);
+  BOOST_CHECK(metar->Phenomenon(9).NumPhenom() == 0);
+  BOOST_CHECK(allocations == before);
+}
+
+BOOST_AUTO_TEST_CASE(metar_allocations_full)
+{
+  // every cloud layer and phenomenon slot in use
+  std::string report = "KSTL 231751Z";
+  for (int i = 0 ; i < 16 ; i++) report += " -RA";
+  for (int i = 1 ; i <= 6 ; i++) report += " BKN00" + std::to_string(i);
+
+  size_t before = allocations;
+  auto metar = Metar::Create(report.c_str());
+  BOOST_CHECK(allocations == before + 2);
+  BOOST_CHECK(metar->NumCloudLayers() == 6);
+  BOOST_CHECK(metar->NumPhenomena() == 16);
+}
+
+BOOST_AUTO_TEST_CASE(metar_layer_outlives_report)
+{
+  std::shared_ptr<Clouds> layer;
+  {
+    auto metar = Metar::Create(REPORT);
+    layer = metar->Layer(0);
+  }
+  BOOST_CHECK(layer->Cover() == Clouds::cover::FEW);
+  BOOST_CHECK(layer->Altitude() == 8);
+}
+
+BOOST_AUTO_TEST_CASE(metar_batch_arena)
+{
+  const size_t n = 100;
+  size_t len = strlen(REPORT);
+
+  auto arena = Arena::Create(64 * 1024);
+
+  std::vector<std::shared_ptr<Metar>> batch;
+  batch.reserve(n);
+
+  size_t before = allocations;
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    batch.push_back(Metar::Create(REPORT, len, arena));
+  }
+
+  // only the arena's blocks, nothing per report
+  BOOST_CHECK(allocations - before == arena->NumBlocks());
+  BOOST_CHECK(arena->NumBlocks() < n / 10);
+
+  BOOST_CHECK(batch[n - 1]->Layer(1)->Cover() == Clouds::cover::SCT);
+  BOOST_CHECK(batch[n - 1]->AltimeterQ() == 1020);
+
+  // the reports keep the arena alive
+  std::weak_ptr<Arena> weak = arena;
+  arena.reset();
+  BOOST_CHECK(!weak.expired());
+  BOOST_CHECK(batch[0]->Phenomenon(2)[0] == Phenom::phenom::MIST);
+
+  batch.clear();
+  BOOST_CHECK(weak.expired());
+}
@@ -0,0 +1,52 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Character classification tests
+//
+
+#include "CharClass.h"
+
+#include <string>
+
+#define BOOST_TEST_MODULE METAR
+#include <boost/test/included/unit_test.hpp>
+
+using namespace Storage_B::Weather;
+
+BOOST_AUTO_TEST_CASE(charclass_masks)
+{
+  const char *str = "KSTL 231751Z 09/M06";
+
+  CharClass::Masks m = CharClass::Classify(str, 19);
+
+  BOOST_CHECK(m.space == ((1 << 4) | (1 << 12)));
+  BOOST_CHECK(m.digit == 0x667E0);   // 231751, 09, 06
+  BOOST_CHECK(m.alpha == 0x1080F);   // KSTL, Z, M
+}
+
+BOOST_AUTO_TEST_CASE(charclass_matches_scalar)
+{
+  // every byte value, at every block length
+  std::string str;
+  for (size_t i = 0 ; i < 256 + CharClass::BLOCK_SIZE ; i++)
+  {
+    str += static_cast<char>(i * 7);
+  }
+
+  size_t errors = 0;
+  for (size_t i = 0 ; i < 256 ; i++)
+  {
+    for (size_t len = 0 ; len <= CharClass::BLOCK_SIZE + 1 ; len++)
+    {
+      CharClass::Masks a = CharClass::Classify(str.data() + i, len);
+      CharClass::Masks b = CharClass::ClassifyScalar(str.data() + i, len);
+      if ((a.space != b.space) || (a.digit != b.digit)
+       || (a.alpha != b.alpha))
+      {
+        errors++;
+      }
+    }
+  }
+
+  BOOST_CHECK(errors == 0);
+}
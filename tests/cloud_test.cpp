@@ -6,6 +6,8 @@
 
 #include "Clouds.h"
 
+#include <climits>
+#include <cstring>
 #include <string>
 
 #define BOOST_TEST_MODULE METAR
@@ -106,3 +108,73 @@ BOOST_AUTO_TEST_CASE(cloud_layer_ACC)
   BOOST_CHECK(result->hasCloudType());
   BOOST_CHECK(result->CloudType() == Clouds::type::ACC);
 }
+
+BOOST_AUTO_TEST_CASE(cloud_layer_length_bounded)
+{
+  const char *str = "OVC007CB SCT020";
+
+  auto result = Clouds::Create(str, size_t(8), true);
+
+  BOOST_CHECK(result->Cover() == Clouds::cover::OVC);
+  BOOST_CHECK(result->Altitude() == 7);
+  BOOST_CHECK(result->CloudType() == Clouds::type::CB);
+  BOOST_CHECK(result->Temporary());
+
+  BOOST_CHECK(Clouds::Create(str, size_t(2)) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(cloud_layer_packed)
+{
+  BOOST_CHECK(sizeof(CloudLayer) == 4);
+
+  CloudLayer layer;
+  BOOST_CHECK(Clouds::Decode("BKN999TCU", 9, true, layer));
+  BOOST_CHECK(layer.Cover() == Clouds::cover::BKN);
+  BOOST_CHECK(layer.Altitude() == 999);
+  BOOST_CHECK(layer.CloudType() == Clouds::type::TCU);
+  BOOST_CHECK(layer.Temporary());
+
+  BOOST_CHECK(Clouds::Decode("CLR", 3, false, layer));
+  BOOST_CHECK(layer.Cover() == Clouds::cover::CLR);
+  BOOST_CHECK(!layer.hasAltitude());
+  BOOST_CHECK(layer.Altitude() == INT_MIN);
+  BOOST_CHECK(!layer.hasCloudType());
+  BOOST_CHECK(!layer.Temporary());
+
+  BOOST_CHECK(!Clouds::Decode("RA", 2, false, layer));
+}
+
+BOOST_AUTO_TEST_CASE(cloud_layer_every_cover)
+{
+  const char *covers[] = { "SKC", "CLR", "NSC", "FEW", "SCT", "BKN", "OVC" };
+
+  CloudLayer layer;
+  for (int i = 0 ; i < 7 ; i++)
+  {
+    BOOST_CHECK(Clouds::Decode(covers[i], 3, false, layer));
+    BOOST_CHECK(layer.Cover() == static_cast<Clouds::cover>(i));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(cloud_layer_rejected)
+{
+  const char *tokens[] =
+  {
+    "-RA", "+TSRA", "BR", "FZFG", "VCSH", "SHRASN", "RMK", "AO2",
+    "OV", "OVX010", "XKC", "BKM022", "SLP123", "TEMPO", "CAVOK"
+  };
+
+  CloudLayer layer;
+  for (const char *tok : tokens)
+  {
+    BOOST_CHECK(!Clouds::Decode(tok, strlen(tok), false, layer));
+  }
+
+  // unknown cloud types are ignored
+  BOOST_CHECK(Clouds::Decode("OVC010CBX", 9, false, layer));
+  BOOST_CHECK(!layer.hasCloudType());
+  BOOST_CHECK(Clouds::Decode("OVC010C", 7, false, layer));
+  BOOST_CHECK(!layer.hasCloudType());
+  BOOST_CHECK(Clouds::Decode("OVC010CB", 8, false, layer));
+  BOOST_CHECK(layer.CloudType() == Clouds::type::CB);
+}
@@ -0,0 +1,227 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Event driven decoder tests
+//
+
+#include "EventDecoder.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE METAR
+#include <boost/test/included/unit_test.hpp>
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+static const char *REPORT =
+    "METAR KSTL 051520Z 12017G25KT 090V150 1 1/2SM -TSRA BR FEW008 "
+    "OVC015CB M06/M08 A2989 RMK AO2 SLP132 T10561078";
+
+//
+// Only wind and altimeter, as a streaming consumer would
+//
+struct WindAltimeter : public MetarHandler
+{
+  int dir = 0;
+  int speed = 0;
+  int gust = 0;
+  int altimeter = 0;
+
+  void on_wind(int d, int s, int g, Metar::speed_units, bool)
+  {
+    dir = d;
+    speed = s;
+    gust = g;
+  }
+
+  void on_altimeter_a(int a) { altimeter = a; }
+};
+
+//
+// Records the order of the events
+//
+struct Trace : public MetarHandler
+{
+  vector<string> events;
+
+  void on_message_type(Metar::message_type) { events.push_back("type"); }
+  void on_icao(const char *icao) { events.push_back(string(icao, 4)); }
+  void on_time(int, int, int) { events.push_back("time"); }
+  void on_wind(int, int, int, Metar::speed_units, bool)
+  {
+    events.push_back("wind");
+  }
+  void on_wind_var(int, int) { events.push_back("wind var"); }
+  void on_visibility(int, Metar::distance_units, bool)
+  {
+    events.push_back("vis");
+  }
+  void on_cloud_layer(const CloudLayer&) { events.push_back("cloud"); }
+  void on_phenom(const PhenomGroup&) { events.push_back("phenom"); }
+  void on_temperature(int, int) { events.push_back("temp"); }
+  void on_altimeter_a(int) { events.push_back("alt"); }
+  void on_remarks(const char *) { events.push_back("rmk"); }
+  void on_sea_level_pressure(int) { events.push_back("slp"); }
+  void on_temperature_na(int, int) { events.push_back("temp na"); }
+};
+
+BOOST_AUTO_TEST_CASE(event_selected_fields)
+{
+  WindAltimeter h;
+  BOOST_TEST(EventDecoder::Decode(REPORT, strlen(REPORT), h));
+
+  BOOST_TEST(h.dir == 120);
+  BOOST_TEST(h.speed == 17);
+  BOOST_TEST(h.gust == 25);
+  BOOST_TEST(h.altimeter == 2989);
+}
+
+BOOST_AUTO_TEST_CASE(event_order)
+{
+  Trace h;
+  BOOST_TEST(EventDecoder::Decode(REPORT, strlen(REPORT), h));
+
+  vector<string> expected
+  {
+    "type", "KSTL", "time", "wind", "wind var", "vis", "phenom", "phenom",
+    "cloud", "cloud", "temp", "alt", "rmk", "slp", "temp na"
+  };
+  BOOST_TEST(h.events == expected, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(event_values_match_record)
+{
+  struct Values : public MetarHandler
+  {
+    int vis = 0;
+    bool vis_lt = true;
+    int temp = 0;
+    int dew = 0;
+    int slp = 0;
+    int ftemp = 0;
+    int fdew = 0;
+    CloudLayer last;
+
+    void on_visibility(int v, Metar::distance_units, bool lt)
+    {
+      vis = v;
+      vis_lt = lt;
+    }
+    void on_temperature(int t, int d)
+    {
+      temp = t;
+      dew = d;
+    }
+    void on_sea_level_pressure(int s) { slp = s; }
+    void on_temperature_na(int t, int d)
+    {
+      ftemp = t;
+      fdew = d;
+    }
+    void on_cloud_layer(const CloudLayer& layer) { last = layer; }
+  } h;
+
+  BOOST_TEST(EventDecoder::Decode(REPORT, strlen(REPORT), h));
+
+  MetarRecord rec;
+  BOOST_TEST(Metar::Decode(REPORT, strlen(REPORT), rec));
+
+  BOOST_TEST(h.vis == rec.vis);
+  BOOST_TEST(h.vis_lt == rec.vis_lt);
+  BOOST_TEST(h.temp == rec.temp);
+  BOOST_TEST(h.dew == rec.dew);
+  BOOST_TEST(h.slp == rec.slp);
+  BOOST_TEST(h.ftemp == rec.ftemp);
+  BOOST_TEST(h.fdew == rec.fdew);
+  BOOST_TEST(h.last.Altitude() == rec.layers[rec.num_layers - 1].Altitude());
+  BOOST_CHECK(h.last.Cover() == rec.layers[rec.num_layers - 1].Cover());
+}
+
+BOOST_AUTO_TEST_CASE(event_undefined_values)
+{
+  WindAltimeter h;
+  const char *report = "KSTL 262051Z VRB04KT 10SM CLR 16/M01";
+  BOOST_TEST(EventDecoder::Decode(report, strlen(report), h));
+
+  BOOST_TEST(h.dir == MetarRecord::INTEGER_UNDEFINED);
+  BOOST_TEST(h.speed == 4);
+  BOOST_TEST(h.gust == MetarRecord::INTEGER_UNDEFINED);
+  BOOST_TEST(h.altimeter == 0);
+}
+
+BOOST_AUTO_TEST_CASE(event_predicate_calls)
+{
+  MetarHandler h;
+  unsigned int events = 0;
+  unsigned int record = 0;
+
+  MetarRecord rec;
+  BOOST_TEST(EventDecoder::Decode(REPORT, strlen(REPORT), h,
+                                  Metar::parse_mode::GRAMMAR, &events));
+  BOOST_TEST(Metar::Decode(REPORT, strlen(REPORT), rec,
+                           Metar::parse_mode::GRAMMAR, Metar::DEFAULT,
+                           &record));
+  BOOST_TEST(events == record);
+}
+
+BOOST_AUTO_TEST_CASE(event_nothing_decoded)
+{
+  MetarHandler h;
+  BOOST_TEST(!EventDecoder::Decode("", 0, h));
+  BOOST_TEST(!EventDecoder::Decode("HELLO, WORLD!", 13, h));
+}
+
+BOOST_AUTO_TEST_CASE(event_projection)
+{
+  Trace h;
+  BOOST_TEST(EventDecoder::Decode(REPORT, strlen(REPORT), h,
+                                  Metar::parse_mode::SEQUENTIAL, nullptr,
+                                  Metar::WIND | Metar::PRESSURE));
+
+  vector<string> expected { "wind", "wind var", "alt", "rmk" };
+  BOOST_TEST(h.events == expected, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(event_deferred)
+{
+  struct Deferring : public Trace
+  {
+    vector<DeferredGroup> groups;
+
+    void on_deferred(const DeferredGroup& group) { groups.push_back(group); }
+  } h;
+
+  BOOST_TEST(EventDecoder::Decode(REPORT, strlen(REPORT), h,
+                                  Metar::parse_mode::SEQUENTIAL, nullptr,
+                                  Metar::WIND | Metar::PRESSURE,
+                                  Metar::PHENOMENA | Metar::REMARKS));
+
+  // decoding goes on past RMK for the deferred remarks
+  vector<string> expected { "wind", "wind var", "alt", "rmk" };
+  BOOST_TEST(h.events == expected, boost::test_tools::per_element());
+
+  vector<string> deferred;
+  for (const DeferredGroup& group : h.groups)
+  {
+    deferred.push_back(string(REPORT + group.offset, group.len));
+  }
+  // every group the decoder would try as a weather phenomenon
+  vector<string> groups { "1", "-TSRA", "BR", "FEW008", "OVC015CB",
+                          "SLP132", "T10561078" };
+  BOOST_TEST(deferred == groups, boost::test_tools::per_element());
+
+  Trace sky;
+  EventDecoder::Replay(REPORT, h.groups.data(), h.groups.size(), sky,
+                       Metar::PHENOMENA);
+  vector<string> phenomena { "phenom", "phenom" };
+  BOOST_TEST(sky.events == phenomena, boost::test_tools::per_element());
+
+  Trace remarks;
+  EventDecoder::Replay(REPORT, h.groups.data(), h.groups.size(), remarks,
+                       Metar::REMARKS);
+  vector<string> rmk { "slp", "temp na" };
+  BOOST_TEST(remarks.events == rmk, boost::test_tools::per_element());
+}
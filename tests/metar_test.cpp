@@ -4,9 +4,18 @@
 // METAR decoder tests
 //
 
+#include "Arena.h"
 #include "Metar.h"
+#include "MetarParser.h"
+#include "MetarRecord.h"
 
+#include <climits>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
 
 #define BOOST_TEST_MODULE METAR
 #include <boost/test/included/unit_test.hpp>
@@ -180,6 +189,15 @@ BOOST_AUTO_TEST_CASE(temperatureNA_NoDew)
   BOOST_CHECK(metar->TemperatureNA() == 2.8);
 }
 
+BOOST_AUTO_TEST_CASE(temperatureNA_truncated_dew)
+{
+  auto metar = Metar::Create("T01670");
+
+  BOOST_CHECK(metar->TemperatureNA() == 16.7);
+  BOOST_CHECK(metar->hasDewPointNA());
+  BOOST_CHECK(metar->DewPointNA() == 0.0);
+}
+
 BOOST_AUTO_TEST_CASE(uninitialized_wind)
 {
   auto metar = Metar::Create("");
@@ -490,6 +508,27 @@ BOOST_AUTO_TEST_CASE(visibility_fraction_sm_3)
   BOOST_CHECK(metar->VisibilityUnits() == Metar::distance_units::SM);
 }
 
+BOOST_AUTO_TEST_CASE(visibility_fraction_sm_2digit)
+{
+  auto metar = Metar::Create("1 11/16SM");
+
+  BOOST_CHECK(metar->hasVisibility());
+  BOOST_CHECK(metar->Visibility() == (27.0 / 16.0));
+  BOOST_CHECK(!metar->isVisibilityLessThan());
+}
+
+BOOST_AUTO_TEST_CASE(visibility_whole_sm_after_digit)
+{
+  // a lone digit only adds whole miles to a fraction
+  auto metar = Metar::Create("1 10SM");
+
+  BOOST_CHECK(metar->hasVisibility());
+  BOOST_CHECK(metar->Visibility() == 10.0);
+
+  metar = Metar::Create("2 3SM");
+  BOOST_CHECK(metar->Visibility() == 3.0);
+}
+
 BOOST_AUTO_TEST_CASE(visibility_LT)
 {
   auto metar = Metar::Create("M1/4SM");
@@ -599,6 +638,105 @@ BOOST_AUTO_TEST_CASE(cloud_layer_3_layers_cloud_types)
   BOOST_CHECK(metar->Layer(2)->CloudType() == Clouds::type::ACC);
 }
 
+BOOST_AUTO_TEST_CASE(cloud_layer_7_layers)
+{
+  const char *str = "KSTL FEW010 FEW020 SCT030 SCT040 BKN050 BKN060 OVC070";
+
+  // the record keeps the first six
+  MetarRecord rec;
+  BOOST_CHECK(Metar::Decode(str, strlen(str), rec));
+  BOOST_CHECK(rec.num_layers == MetarRecord::MAX_CLOUD_LAYERS);
+  BOOST_CHECK(rec.truncated);
+
+  // the reports keep every layer
+  auto eager = Metar::Create(str);
+  auto lazy = Metar::CreateLazy(str, strlen(str));
+  auto in_arena = Metar::Create(str, strlen(str), Arena::Create());
+  auto parser = MetarParser::Create();
+  parser->Parse(str, strlen(str));
+
+  const Metar *reports[] = {
+    eager.get(), lazy.get(), in_arena.get(), &parser->Report()
+  };
+
+  for (const Metar *metar : reports)
+  {
+    BOOST_REQUIRE(metar->NumCloudLayers() == 7);
+    BOOST_CHECK(metar->Record().truncated);
+    for (unsigned int i = 0 ; i < 7 ; i++)
+    {
+      int altitude = static_cast<int>(i + 1) * 10;
+      BOOST_CHECK(metar->Layer(i)->Altitude() == altitude);
+      BOOST_CHECK(metar->CloudLayers()[i].Altitude() == altitude);
+    }
+    BOOST_CHECK(metar->Layer(6)->Cover() == Clouds::cover::OVC);
+    BOOST_CHECK(metar->Layer(7) == nullptr);
+  }
+
+  // exactly six fit
+  auto metar = Metar::Create("KSTL FEW010 FEW020 SCT030 SCT040 BKN050 BKN060");
+  BOOST_CHECK(metar->NumCloudLayers() == 6);
+  BOOST_CHECK(!metar->Record().truncated);
+}
+
+BOOST_AUTO_TEST_CASE(phenomena_past_record_cap)
+{
+  std::string str("KSTL");
+  for (unsigned int i = 0 ; i < MetarRecord::MAX_PHENOMENA ; i++)
+  {
+    str += " -RA";
+  }
+  str += " +SN BR";
+
+  MetarRecord rec;
+  BOOST_CHECK(Metar::Decode(str.c_str(), str.size(), rec));
+  BOOST_CHECK(rec.num_phenomena == MetarRecord::MAX_PHENOMENA);
+  BOOST_CHECK(rec.truncated);
+
+  auto metar = Metar::Create(str.c_str());
+  BOOST_REQUIRE(metar->NumPhenomena() == MetarRecord::MAX_PHENOMENA + 2);
+  BOOST_CHECK(metar->Record().truncated);
+  BOOST_CHECK(metar->Phenomenon(15)[0] == Phenom::phenom::RAIN);
+  BOOST_CHECK(metar->Phenomenon(16)[0] == Phenom::phenom::SNOW);
+  BOOST_CHECK(metar->Phenomenon(16).Intensity() == Phenom::intensity::HEAVY);
+  BOOST_CHECK(metar->Phenomenon(17)[0] == Phenom::phenom::MIST);
+  BOOST_CHECK(metar->Phenomenon(18).NumPhenom() == 0);
+
+  auto lazy = Metar::CreateLazy(str.c_str(), str.size());
+  BOOST_REQUIRE(lazy->NumPhenomena() == MetarRecord::MAX_PHENOMENA + 2);
+  BOOST_CHECK(lazy->Phenomenon(17)[0] == Phenom::phenom::MIST);
+}
+
+BOOST_AUTO_TEST_CASE(cloud_layer_values)
+{
+  auto metar = Metar::Create("BKN004 TEMPO OVC250CB");
+
+  BOOST_CHECK(metar->NumCloudLayers() == 2);
+
+  const CloudLayer *layers = metar->CloudLayers();
+
+  // lowest broken or overcast layer
+  int ceiling = INT_MIN;
+  for (unsigned int i = 0 ; i < metar->NumCloudLayers() ; i++)
+  {
+    if ((layers[i].Cover() == Clouds::cover::BKN) ||
+        (layers[i].Cover() == Clouds::cover::OVC))
+    {
+      ceiling = layers[i].Altitude();
+      break;
+    }
+  }
+  BOOST_CHECK(ceiling == 4);
+
+  BOOST_CHECK(!layers[0].Temporary());
+  BOOST_CHECK(!layers[0].hasCloudType());
+  BOOST_CHECK(layers[1].Temporary());
+  BOOST_CHECK(layers[1].Altitude() == 250);
+  BOOST_CHECK(layers[1].CloudType() == Clouds::type::CB);
+
+  BOOST_CHECK(metar->Layer(1)->Altitude() == layers[1].Altitude());
+}
+
 BOOST_AUTO_TEST_CASE(phenom_tempo)
 {
     auto metar = Metar::Create("EDDH VCBLSN TEMPO SHSN");
@@ -1046,3 +1184,554 @@ BOOST_AUTO_TEST_CASE(real_METAR_9)
   BOOST_CHECK(metar->TemperatureNA() == 6.1);
   BOOST_CHECK(metar->DewPointNA() == 0.6);
 }
+
+BOOST_AUTO_TEST_CASE(concurrent_decode)
+{
+  const char *reports[] =
+  {
+    "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029 RMK AO2 SLP260 T00940061",
+    "METAR LBBG 041600Z 12012MPS 090V150 1400 +SN BKN022 OVC050 M04/M07 Q1020"
+  };
+
+  std::vector<int> errors(4, 0);
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0 ; t < errors.size() ; t++)
+  {
+    threads.emplace_back([&reports, &errors, t]()
+    {
+      for (int i = 0 ; i < 1000 ; i++)
+      {
+        auto metar = Metar::Create(reports[(t + i) % 2]);
+        bool first = ((t + i) % 2) == 0;
+
+        if (strcmp(metar->ICAO(), first ? "KSTL" : "LBBG")
+            || (metar->NumCloudLayers() != (first ? 1U : 2U))
+            || (metar->Temperature() != (first ? 9 : -4)))
+        {
+          errors[t]++;
+        }
+      }
+    });
+  }
+
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+
+  for (auto e : errors)
+  {
+    BOOST_CHECK(e == 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(lazy_matches_eager)
+{
+  const char *reports[] =
+  {
+    "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029 RMK AO2 SLP260 T00940061",
+    "METAR LBBG 041600Z 12012MPS 090V150 1400 +SN BKN022 OVC050 M04/M07 Q1020",
+    "KHLN 041610Z 28009KT 1/2SM SN FZFG VV007 M10/M12 A2998 RMK AO2 T11001117",
+    "EDDH 161150Z 24015G27KT 9999 VCBLSN FEW012 SCT025 TEMPO SHSN 01/M02 Q1003",
+    "SLP132 T00280011",
+    "KSTL 051520Z 12017KT 10SM A2989 24010MPS RMK AO2 Q0998 SLP132",
+    "KHLN 041610Z RMK 1/2SM SN VV007 M10/M12 28009KT AO2 A2998 T11001117"
+  };
+
+  for (auto report : reports)
+  {
+    std::string text(report);
+    auto eager = Metar::Create(text.c_str());
+    auto lazy = Metar::CreateLazy(text.data(), text.size());
+
+    // the report is copied
+    text.assign(text.size(), ' ');
+
+    BOOST_TEST(lazy->Day() == eager->Day());
+    BOOST_TEST(lazy->WindSpeed() == eager->WindSpeed());
+    BOOST_TEST(lazy->Visibility() == eager->Visibility());
+    BOOST_TEST(lazy->Temperature() == eager->Temperature());
+    BOOST_TEST(lazy->hasAltimeterQ() == eager->hasAltimeterQ());
+    BOOST_TEST(lazy->AltimeterQ() == eager->AltimeterQ());
+
+    BOOST_TEST(lazy->hasSeaLevelPressure() == eager->hasSeaLevelPressure());
+    BOOST_TEST(lazy->SeaLevelPressure() == eager->SeaLevelPressure());
+    BOOST_TEST(lazy->DewPointNA() == eager->DewPointNA());
+    BOOST_TEST(lazy->VerticalVisibility() == eager->VerticalVisibility());
+
+    BOOST_TEST(lazy->NumCloudLayers() == eager->NumCloudLayers());
+    for (unsigned int i = 0 ; i < eager->NumCloudLayers() ; i++)
+    {
+      BOOST_TEST(lazy->Layer(i)->Altitude() == eager->Layer(i)->Altitude());
+      BOOST_TEST(lazy->Layer(i)->Temporary() == eager->Layer(i)->Temporary());
+    }
+
+    BOOST_TEST(lazy->NumPhenomena() == eager->NumPhenomena());
+    for (unsigned int i = 0 ; i < eager->NumPhenomena() ; i++)
+    {
+      BOOST_TEST(lazy->Phenomenon(i).NumPhenom() ==
+                 eager->Phenomenon(i).NumPhenom());
+      BOOST_TEST(lazy->Phenomenon(i).Temporary() ==
+                 eager->Phenomenon(i).Temporary());
+    }
+
+    const MetarRecord& rec = lazy->Record();
+    BOOST_TEST(rec.slp == eager->Record().slp);
+    BOOST_TEST(rec.num_layers == eager->Record().num_layers);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(lazy_concurrent_access)
+{
+  const char *report =
+      "KHLN 041610Z 28009KT 1/2SM SN FZFG VV007 FEW010 BKN020 OVC030 "
+      "M10/M12 A2998 RMK AO2 SLP132 T11001117";
+
+  for (int i = 0 ; i < 200 ; i++)
+  {
+    auto metar = Metar::CreateLazy(report, strlen(report));
+
+    std::vector<int> errors(4, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0 ; t < errors.size() ; t++)
+    {
+      threads.emplace_back([&metar, &errors, t]()
+      {
+        if ((metar->NumCloudLayers() != 3)
+         || (metar->Layer(2)->Altitude() != 30)
+         || (metar->NumPhenomena() != 2)
+         || (metar->TemperatureNA() != -10.0)
+         || (metar->WindSpeed() != 9))
+        {
+          errors[t]++;
+        }
+      });
+    }
+
+    for (auto& t : threads)
+    {
+      t.join();
+    }
+
+    for (auto e : errors)
+    {
+      BOOST_CHECK(e == 0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(decode_length_bounded)
+{
+  const char buffer[] = "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029 XXXX";
+  const std::string copy(buffer);
+
+  // stop before " A3029"
+  auto metar = Metar::Create(buffer, 38);
+
+  BOOST_CHECK(strcmp(metar->ICAO(), "KSTL") == 0);
+  BOOST_CHECK(metar->WindSpeed() == 9);
+  BOOST_CHECK(metar->NumCloudLayers() == 1);
+  BOOST_CHECK(metar->DewPoint() == 6);
+  BOOST_CHECK(!metar->hasAltimeterA());
+
+  BOOST_CHECK(copy == buffer);
+}
+
+BOOST_AUTO_TEST_CASE(decode_read_only_mapping)
+{
+  //
+  // The report ends exactly at a page boundary that is followed by an
+  // inaccessible page, so any write or read past the end faults
+  //
+  const char *report = "KSTL 192051Z 20004KT 10SM -RA FEW034 22/18 T02220178";
+  size_t len = strlen(report);
+  size_t page = sysconf(_SC_PAGESIZE);
+
+  char *mem = static_cast<char *>(mmap(nullptr, 2 * page,
+      PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  BOOST_REQUIRE(mem != MAP_FAILED);
+
+  char *str = mem + page - len;
+  memcpy(str, report, len);
+  BOOST_REQUIRE(mprotect(mem, page, PROT_READ) == 0);
+  BOOST_REQUIRE(mprotect(mem + page, page, PROT_NONE) == 0);
+
+  auto metar = Metar::Create(str, len);
+
+  BOOST_CHECK(metar->Day() == 19);
+  BOOST_CHECK(metar->NumPhenomena() == 1);
+  BOOST_CHECK(metar->Layer(0)->Altitude() == 34);
+  BOOST_CHECK(metar->Temperature() == 22);
+  BOOST_CHECK(metar->DewPointNA() == 17.8);
+
+  munmap(mem, 2 * page);
+}
+
+BOOST_AUTO_TEST_CASE(grammar_mode_matches_sequential)
+{
+  const char *reports[] =
+  {
+    "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029 RMK AO2 SLP260 T00940061 10100 20078 53002",
+    "METAR LBBG 041600Z 12012MPS 090V150 1400 R04/P1500N R22/P1500U +SN BKN022 OVC050 M04/M07 Q1020 NOSIG 8849//91=",
+    "KHLN 041610Z 28009KT 1/2SM SN FZFG VV007 M10/M12 A2998 RMK AO2 P0001 T11001117",
+    "KSTL 091651Z 10010KT 060V120 2 1/2SM FEW120 BKN250 07/M06 A2998 RMK AO2 SLP160 T00671056",
+    "EDDH 161150Z 24015G27KT 9999 VCBLSN FEW012 TEMPO SHSN 01/M02 Q1003"
+  };
+
+  unsigned int seq_total = 0, gram_total = 0;
+
+  for (auto report : reports)
+  {
+    unsigned int seq_calls, gram_calls;
+    auto seq = Metar::Create(report, strlen(report),
+                             Metar::parse_mode::SEQUENTIAL, &seq_calls);
+    auto gram = Metar::Create(report, strlen(report),
+                              Metar::parse_mode::GRAMMAR, &gram_calls);
+
+    seq_total += seq_calls;
+    gram_total += gram_calls;
+
+    BOOST_CHECK(strcmp(seq->ICAO(), gram->ICAO()) == 0);
+    BOOST_CHECK(seq->Minute() == gram->Minute());
+    BOOST_CHECK(seq->WindSpeed() == gram->WindSpeed());
+    BOOST_CHECK(seq->WindGust() == gram->WindGust());
+    BOOST_CHECK(seq->MaxWindDirection() == gram->MaxWindDirection());
+    BOOST_CHECK(seq->Visibility() == gram->Visibility());
+    BOOST_CHECK(seq->VerticalVisibility() == gram->VerticalVisibility());
+    BOOST_CHECK(seq->NumCloudLayers() == gram->NumCloudLayers());
+    BOOST_CHECK(seq->NumPhenomena() == gram->NumPhenomena());
+    BOOST_CHECK(seq->DewPoint() == gram->DewPoint());
+    BOOST_CHECK(seq->AltimeterA() == gram->AltimeterA());
+    BOOST_CHECK(seq->AltimeterQ() == gram->AltimeterQ());
+    BOOST_CHECK(seq->SeaLevelPressure() == gram->SeaLevelPressure());
+    BOOST_CHECK(seq->DewPointNA() == gram->DewPointNA());
+  }
+
+  // a group past its place (EDDH's TEMPO) costs GRAMMAR a search back
+  BOOST_CHECK(gram_total < seq_total);
+}
+
+BOOST_AUTO_TEST_CASE(grammar_mode_out_of_order)
+{
+  const char *report = "FEW004 09/06 KSTL 231751Z A3029 27009KT";
+
+  auto metar = Metar::Create(report, strlen(report),
+                             Metar::parse_mode::GRAMMAR);
+
+  BOOST_CHECK(metar->NumCloudLayers() == 1);
+  BOOST_CHECK(metar->Temperature() == 9);
+  BOOST_CHECK(strcmp(metar->ICAO(), "KSTL") == 0);
+  BOOST_CHECK(metar->Minute() == 51);
+  BOOST_CHECK(metar->AltimeterA() == 30.29);
+  BOOST_CHECK(metar->WindDirection() == 270);
+}
+
+BOOST_AUTO_TEST_CASE(grammar_mode_out_of_order_matches_sequential)
+{
+  const char *reports[] =
+  {
+    "041610Z 28009KT 1/2SM SN FZFG VV007 M10/M12 A2998",
+    "FEW004 09/06 KSTL 231751Z A3029 27009KT",
+    "KSTL 27009KT METAR 231751Z -RA BR OVC005 SPECI A3029"
+  };
+
+  for (auto report : reports)
+  {
+    auto seq = Metar::Create(report, strlen(report),
+                             Metar::parse_mode::SEQUENTIAL);
+    auto gram = Metar::Create(report, strlen(report),
+                              Metar::parse_mode::GRAMMAR);
+
+    BOOST_CHECK(seq->hasMessageType() == gram->hasMessageType());
+    BOOST_CHECK(seq->MessageType() == gram->MessageType());
+    BOOST_CHECK(seq->hasICAO() == gram->hasICAO());
+    if (seq->hasICAO() && gram->hasICAO())
+    {
+      BOOST_CHECK(strcmp(seq->ICAO(), gram->ICAO()) == 0);
+    }
+    BOOST_CHECK(seq->Minute() == gram->Minute());
+    BOOST_CHECK(seq->WindDirection() == gram->WindDirection());
+    BOOST_CHECK(seq->Visibility() == gram->Visibility());
+    BOOST_CHECK(seq->VerticalVisibility() == gram->VerticalVisibility());
+    BOOST_CHECK(seq->NumCloudLayers() == gram->NumCloudLayers());
+    BOOST_CHECK(seq->NumPhenomena() == gram->NumPhenomena());
+    BOOST_CHECK(seq->Temperature() == gram->Temperature());
+    BOOST_CHECK(seq->AltimeterA() == gram->AltimeterA());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(decode_record)
+{
+  const char *reports[] =
+  {
+    "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029 RMK AO2 SLP260 T00940061",
+    "garbage",
+    "SPECI KSTL 221513Z 07005KT 2SM -RA BR OVC005 02/02 A3041 RMK AO2 P0001"
+  };
+
+  std::vector<MetarRecord> records(3);
+  std::vector<bool> ok;
+
+  for (size_t i = 0 ; i < 3 ; i++)
+  {
+    ok.push_back(Metar::Decode(reports[i], strlen(reports[i]), records[i]));
+  }
+
+  BOOST_CHECK(ok[0]);
+  BOOST_CHECK(!ok[1]);
+  BOOST_CHECK(ok[2]);
+
+  // records are plain values
+  MetarRecord copy;
+  memcpy(&copy, &records[0], sizeof(copy));
+
+  BOOST_CHECK(strcmp(copy.icao, "KSTL") == 0);
+  BOOST_CHECK(copy.wind_dir == 270);
+  BOOST_CHECK(copy.Visibility() == 10);
+  BOOST_CHECK(copy.num_layers == 1);
+  BOOST_CHECK(copy.layers[0].Cover() == Clouds::cover::OVC);
+  BOOST_CHECK(copy.layers[0].Altitude() == 15);
+  BOOST_CHECK(copy.AltimeterA() == 30.29);
+  BOOST_CHECK(copy.SeaLevelPressure() == 1026.0);
+  BOOST_CHECK(copy.hasTemperatureNA());
+  BOOST_CHECK(!copy.hasAltimeterQ());
+
+  BOOST_CHECK(!records[1].hasICAO());
+
+  BOOST_CHECK(records[2].message_type == Metar::message_type::SPECI);
+  BOOST_CHECK(records[2].num_phenomena == 2);
+  BOOST_CHECK(records[2].phenomena[0].phenoms ==
+              PhenomGroup::Mask(Phenom::phenom::RAIN));
+  BOOST_CHECK(records[2].phenomena[0].Intensity() ==
+              Phenom::intensity::LIGHT);
+  BOOST_CHECK(records[2].phenomena[1].Has(Phenom::phenom::MIST));
+
+  auto metar = Metar::Create(reports[2]);
+  const auto& rec = metar->Record();
+  BOOST_CHECK(rec.minute == records[2].minute);
+  BOOST_CHECK(rec.num_phenomena == records[2].num_phenomena);
+  BOOST_CHECK(rec.layers[0].altitude == records[2].layers[0].altitude);
+}
+
+BOOST_AUTO_TEST_CASE(record_fixed_point)
+{
+  const char *report =
+      "KSTL 231751Z 27009KT 1 5/16SM OVC015 09/06 A2992 RMK SLP132 T10941061";
+
+  MetarRecord rec;
+  BOOST_CHECK(Metar::Decode(report, strlen(report), rec));
+
+  BOOST_CHECK(rec.vis == 21);
+  BOOST_CHECK(rec.Visibility() == 1.3125);
+  BOOST_CHECK(rec.altimeterA == 2992);
+  BOOST_CHECK(rec.AltimeterA() == 29.92);
+  BOOST_CHECK(rec.slp == 10132);
+  BOOST_CHECK(rec.SeaLevelPressure() == 1013.2);
+  BOOST_CHECK(rec.ftemp == -94);
+  BOOST_CHECK(rec.TemperatureNA() == -9.4);
+  BOOST_CHECK(rec.fdew == -61);
+  BOOST_CHECK(rec.DewPointNA() == -6.1);
+
+  const char *metric = "LBBG 041600Z 12012MPS 1400 M04/M07 Q1020";
+  BOOST_CHECK(Metar::Decode(metric, strlen(metric), rec));
+
+  BOOST_CHECK(rec.vis == 1400);
+  BOOST_CHECK(rec.Visibility() == 1400.0);
+  BOOST_CHECK(!rec.hasAltimeterA());
+  BOOST_CHECK(rec.AltimeterA() == MetarRecord::DOUBLE_UNDEFINED);
+  BOOST_CHECK(rec.SeaLevelPressure() == MetarRecord::DOUBLE_UNDEFINED);
+  BOOST_CHECK(!rec.hasTemperatureNA());
+}
+
+BOOST_AUTO_TEST_CASE(decode_normalized, * boost::unit_test::tolerance(0.005))
+{
+  const char *kt =
+      "KSTL 231751Z 27009G15KT 1 1/2SM OVC015 09/06 A3029 RMK AO2 T00940061";
+  const char *mps = "METAR LBBG 041600Z 12012MPS 1400 M04/M07 Q1020 A3012";
+  const char *kph = "UUEE 041600Z 09036KPH CAVOK M12/ Q1005";
+
+  MetarRecord rec;
+
+  BOOST_CHECK(Metar::Decode(kt, strlen(kt), rec,
+                            Metar::parse_mode::SEQUENTIAL, Metar::NORMALIZE));
+  BOOST_CHECK(rec.wind_spd_cms == 463);
+  BOOST_CHECK(rec.gust_cms == 772);
+  BOOST_CHECK(rec.vis_m == 2414);
+  BOOST_CHECK(rec.pressure_dhpa == 10257);
+  BOOST_TEST(rec.WindSpeedSI() == 9 * 0.514444);
+  BOOST_TEST(rec.WindGustSI() == 15 * 0.514444);
+  BOOST_TEST(rec.VisibilitySI() == 1.5 * 1609.34);
+  BOOST_TEST(rec.PressureSI() == 30.29 / 0.02953);
+  BOOST_TEST(rec.TemperatureSI() == 9.4);
+  BOOST_CHECK(rec.temp_dc == 94);
+  BOOST_CHECK(rec.dew_dc == 61);
+  BOOST_CHECK(rec.wind_spd == 9);
+  BOOST_CHECK(rec.wind_speed_units == Metar::speed_units::KT);
+
+  BOOST_CHECK(Metar::Decode(mps, strlen(mps), rec,
+                            Metar::parse_mode::GRAMMAR, Metar::NORMALIZE));
+  BOOST_CHECK(rec.wind_spd_cms == 1200);
+  BOOST_CHECK(!rec.hasWindGustSI());
+  BOOST_CHECK(rec.vis_m == 1400);
+  BOOST_CHECK(rec.pressure_dhpa == 10200);
+  BOOST_CHECK(rec.temp_dc == -40);
+  BOOST_CHECK(rec.dew_dc == -70);
+
+  BOOST_CHECK(Metar::Decode(kph, strlen(kph), rec,
+                            Metar::parse_mode::SEQUENTIAL, Metar::NORMALIZE));
+  BOOST_TEST(rec.WindSpeedSI() == 36 / 3.6);
+  BOOST_CHECK(rec.vis_m == 10000);
+  BOOST_CHECK(rec.temp_dc == -120);
+  BOOST_CHECK(!rec.hasDewPointSI());
+
+  // not filled by default
+  BOOST_CHECK(Metar::Decode(kt, strlen(kt), rec));
+  BOOST_CHECK(!rec.hasWindSpeedSI());
+  BOOST_CHECK(!rec.hasVisibilitySI());
+  BOOST_CHECK(!rec.hasPressureSI());
+  BOOST_CHECK(!rec.hasTemperatureSI());
+
+  BOOST_CHECK(Metar::Decode(mps, strlen(mps), rec,
+                            Metar::parse_mode::SEQUENTIAL, 0));
+  BOOST_CHECK(!rec.hasWindSpeedSI());
+
+  MetarText batch[] = { { kt, strlen(kt) }, { mps, strlen(mps) } };
+  MetarRecord out[2];
+  Metar::DecodeBatch(batch, 2, out, nullptr, Metar::parse_mode::SEQUENTIAL,
+                     Metar::NORMALIZE);
+  BOOST_CHECK(out[0].temp_dc == 94);
+  BOOST_CHECK(out[1].pressure_dhpa == 10200);
+}
+
+BOOST_AUTO_TEST_CASE(decode_projection)
+{
+  const char *report =
+      "METAR KSTL 051520Z 12017G25KT 5SM -TSRA BR OVC007CB 06/05 A2989 "
+      "RMK AO2 SLP132 T00560050";
+
+  MetarRecord rec;
+
+  BOOST_CHECK(Metar::Decode(report, strlen(report), rec,
+                            Metar::parse_mode::SEQUENTIAL,
+                            Metar::WIND | Metar::PRESSURE));
+  BOOST_CHECK(rec.wind_spd == 17);
+  BOOST_CHECK(rec.gust == 25);
+  BOOST_CHECK(rec.altimeterA == 2989);
+  BOOST_CHECK(!rec.hasMessageType());
+  BOOST_CHECK(!rec.hasICAO());
+  BOOST_CHECK(!rec.hasDay());
+  BOOST_CHECK(!rec.hasVisibility());
+  BOOST_CHECK(!rec.hasTemperature());
+  BOOST_CHECK(rec.num_layers == 0);
+  BOOST_CHECK(rec.num_phenomena == 0);
+
+  // remarks skipped
+  BOOST_CHECK(!rec.hasSeaLevelPressure());
+  BOOST_CHECK(!rec.hasTemperatureNA());
+
+  BOOST_CHECK(Metar::Decode(report, strlen(report), rec,
+                            Metar::parse_mode::SEQUENTIAL,
+                            Metar::NORMALIZE | Metar::TEMPERATURE
+                            | Metar::TEMPERATURE_NA));
+  BOOST_CHECK(rec.temp == 6);
+  BOOST_CHECK(rec.ftemp == 56);
+  BOOST_CHECK(rec.temp_dc == 56);
+  BOOST_CHECK(!rec.hasWindSpeed());
+  BOOST_CHECK(!rec.hasSeaLevelPressure());
+
+  BOOST_CHECK(Metar::Decode(report, strlen(report), rec,
+                            Metar::parse_mode::GRAMMAR, Metar::CLOUDS));
+  BOOST_CHECK(rec.num_layers == 1);
+  BOOST_CHECK(rec.num_phenomena == 0);
+  BOOST_CHECK(!rec.hasAltimeterA());
+
+  // every field is the same as no projection
+  BOOST_CHECK(Metar::Decode(report, strlen(report), rec,
+                            Metar::parse_mode::SEQUENTIAL,
+                            Metar::ALL_FIELDS));
+  BOOST_CHECK(rec.hasMessageType());
+  BOOST_CHECK(rec.minute == 20);
+  BOOST_CHECK(rec.vis == 5 * MetarRecord::VIS_SM_SCALE);
+  BOOST_CHECK(rec.num_layers == 1);
+  BOOST_CHECK(rec.num_phenomena == 2);
+  BOOST_CHECK(rec.slp == 10132);
+  BOOST_CHECK(rec.fdew == 50);
+}
+
+BOOST_AUTO_TEST_CASE(decode_record_reuse)
+{
+  MetarRecord rec;
+
+  const char *first = "KSTL 231751Z 27009KT OVC015 09/06";
+  const char *second = "LBBG 041600Z";
+
+  Metar::Decode(first, strlen(first), rec);
+  Metar::Decode(second, strlen(second), rec);
+
+  BOOST_CHECK(strcmp(rec.icao, "LBBG") == 0);
+  BOOST_CHECK(!rec.hasWindSpeed());
+  BOOST_CHECK(!rec.hasTemperature());
+  BOOST_CHECK(rec.num_layers == 0);
+}
+
+BOOST_AUTO_TEST_CASE(decode_batch)
+{
+  const char *buffer =
+      "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029\n"
+      "???\n"
+      "LBBG 041600Z 12012MPS 1400 +SN BKN022 OVC050 M04/M07 Q1020";
+
+  MetarText in[3];
+  const char *p = buffer;
+  for (auto& text : in)
+  {
+    const char *end = strchr(p, '\n');
+    if (!end) end = p + strlen(p);
+
+    text.str = p;
+    text.len = end - p;
+    p = end + 1;
+  }
+
+  MetarRecord out[3];
+  bool ok[3];
+
+  BOOST_CHECK(Metar::DecodeBatch(in, 3, out, ok) == 2);
+
+  BOOST_CHECK(ok[0]);
+  BOOST_CHECK(strcmp(out[0].icao, "KSTL") == 0);
+  BOOST_CHECK(out[0].AltimeterA() == 30.29);
+
+  BOOST_CHECK(!ok[1]);
+
+  BOOST_CHECK(ok[2]);
+  BOOST_CHECK(strcmp(out[2].icao, "LBBG") == 0);
+  BOOST_CHECK(out[2].num_layers == 2);
+  BOOST_CHECK(out[2].num_phenomena == 1);
+  BOOST_CHECK(out[2].altimeterQ == 1020);
+  BOOST_CHECK(!out[2].hasAltimeterA());
+}
+
+BOOST_AUTO_TEST_CASE(decode_block_boundaries)
+{
+  const char *report = "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029";
+
+  // slide the report across the 64 byte classification blocks so every
+  // group straddles a boundary at some offset
+  for (size_t pad = 0 ; pad < 70 ; pad++)
+  {
+    std::string str(pad, ' ');
+    str += report;
+
+    MetarRecord rec;
+    BOOST_REQUIRE(Metar::Decode(str.data(), str.size(), rec));
+    BOOST_CHECK(strcmp(rec.icao, "KSTL") == 0);
+    BOOST_CHECK(rec.minute == 51);
+    BOOST_CHECK(rec.wind_spd == 9);
+    BOOST_CHECK(rec.Visibility() == 10);
+    BOOST_CHECK(rec.num_layers == 1);
+    BOOST_CHECK(rec.dew == 6);
+    BOOST_CHECK(rec.AltimeterA() == 30.29);
+  }
+}
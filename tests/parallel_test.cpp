@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Parallel decoder tests
+//
+
+#include "ParallelDecoder.h"
+
+#include <string>
+#include <cstring>
+#include <thread>
+
+#define BOOST_TEST_MODULE METAR
+#include <boost/test/included/unit_test.hpp>
+
+using namespace Storage_B::Weather;
+
+namespace
+{
+  const char *REPORTS[] =
+  {
+    "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029 RMK AO2 SLP260 T00940061",
+    "METAR LBBG 041600Z 12012MPS 090V150 1400 +SN BKN022 OVC050 M04/M07 Q1020",
+    "KHLN 041610Z 28009KT 1/2SM SN FZFG VV007 M10/M12 A2998 RMK AO2 T11001117",
+    "2018/11/23 17:51"
+  };
+
+  std::string make_archive(size_t lines)
+  {
+    std::string archive;
+    for (size_t i = 0 ; i < lines ; i++)
+    {
+      archive += REPORTS[i % 4];
+      archive += (i % 3) ? "\n" : "\r\n";
+    }
+    return archive;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_input_order)
+{
+  const size_t lines = 5000;
+  std::string archive = make_archive(lines);
+
+  // small chunks so every worker gets, and steals, plenty of them
+  auto decoder = ParallelDecoder::Create(4, 512);
+
+  std::vector<MetarRecord> out;
+  std::vector<bool> ok;
+
+  size_t decoded = decoder->Decode(archive.data(), archive.size(), out, &ok);
+
+  BOOST_CHECK(decoder->NumThreads() == 4);
+  BOOST_REQUIRE(out.size() == lines);
+  BOOST_REQUIRE(ok.size() == lines);
+  BOOST_CHECK(decoded == lines - lines / 4);
+
+  size_t errors = 0;
+  for (size_t i = 0 ; i < lines ; i++)
+  {
+    switch (i % 4)
+    {
+      case 0:
+        if (!ok[i] || strcmp(out[i].icao, "KSTL") || out[i].TemperatureNA() != 9.4)
+          errors++;
+        break;
+
+      case 1:
+        if (!ok[i] || strcmp(out[i].icao, "LBBG") || out[i].num_layers != 2)
+          errors++;
+        break;
+
+      case 2:
+        if (!ok[i] || strcmp(out[i].icao, "KHLN") || out[i].vert_vis != 700)
+          errors++;
+        break;
+
+      default:
+        if (ok[i]) errors++;
+        break;
+    }
+  }
+  BOOST_CHECK(errors == 0);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_matches_serial)
+{
+  std::string archive = make_archive(999);
+
+  std::vector<MetarRecord> serial, parallel;
+
+  ParallelDecoder::Create(1)->Decode(archive.data(), archive.size(), serial);
+  ParallelDecoder::Create(3, 100)->Decode(archive.data(), archive.size(),
+                                          parallel);
+
+  BOOST_REQUIRE(serial.size() == parallel.size());
+  for (size_t i = 0 ; i < serial.size() ; i++)
+  {
+    BOOST_CHECK(serial[i].minute == parallel[i].minute);
+    BOOST_CHECK(serial[i].temp == parallel[i].temp);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_edge_cases)
+{
+  auto decoder = ParallelDecoder::Create(2, 16);
+
+  std::vector<MetarRecord> out;
+  std::vector<bool> ok;
+
+  BOOST_CHECK(decoder->Decode("", 0, out, &ok) == 0);
+  BOOST_CHECK(out.empty());
+  BOOST_CHECK(ok.empty());
+
+  // blank lines are skipped, no trailing newline
+  const char *buffer = "\n\nKSTL 231751Z\n\r\nLBBG 041600Z";
+  BOOST_CHECK(decoder->Decode(buffer, strlen(buffer), out, &ok) == 2);
+  BOOST_REQUIRE(out.size() == 2);
+  BOOST_CHECK(strcmp(out[0].icao, "KSTL") == 0);
+  BOOST_CHECK(strcmp(out[1].icao, "LBBG") == 0);
+
+  // reusable
+  BOOST_CHECK(decoder->Decode(buffer, 14, out) == 1);
+  BOOST_CHECK(out.size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_normalized)
+{
+  std::string archive = make_archive(400);
+
+  auto decoder = ParallelDecoder::Create(2, 256);
+
+  std::vector<MetarRecord> out;
+  decoder->Decode(archive.data(), archive.size(), out, nullptr,
+                  Metar::parse_mode::SEQUENTIAL, Metar::NORMALIZE);
+
+  BOOST_REQUIRE(out.size() == 400);
+  BOOST_CHECK(out[0].temp_dc == 94);
+  BOOST_CHECK(out[1].wind_spd_cms == 1200);
+  BOOST_CHECK(out[2].temp_dc == -100);
+  BOOST_CHECK(!out[3].hasTemperatureSI());
+}
+
+BOOST_AUTO_TEST_CASE(parallel_concurrent_calls)
+{
+  std::string archive = make_archive(2000);
+
+  std::vector<MetarRecord> expected;
+  ParallelDecoder::Create(1)->Decode(archive.data(), archive.size(),
+                                     expected);
+
+  // one decoder shared by several calling threads
+  auto decoder = ParallelDecoder::Create(3, 256);
+
+  const int num_callers = 4;
+  std::vector<MetarRecord> out[num_callers];
+  size_t decoded[num_callers];
+
+  std::vector<std::thread> callers;
+  for (int c = 0 ; c < num_callers ; c++)
+  {
+    callers.emplace_back([&, c]
+    {
+      for (int pass = 0 ; pass < 10 ; pass++)
+      {
+        decoded[c] = decoder->Decode(archive.data(), archive.size(),
+                                     out[c]);
+      }
+    });
+  }
+
+  for (auto& t : callers)
+  {
+    t.join();
+  }
+
+  for (int c = 0 ; c < num_callers ; c++)
+  {
+    BOOST_CHECK(decoded[c] == 1500);
+    BOOST_REQUIRE(out[c].size() == expected.size());
+
+    size_t errors = 0;
+    for (size_t i = 0 ; i < expected.size() ; i++)
+    {
+      if (strcmp(out[c][i].icao, expected[i].icao)
+          || out[c][i].minute != expected[i].minute
+          || out[c][i].temp != expected[i].temp)
+      {
+        errors++;
+      }
+    }
+    BOOST_CHECK(errors == 0);
+  }
+}
@@ -0,0 +1,173 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Reusable parser tests
+//
+
+#include "MetarParser.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#define BOOST_TEST_MODULE METAR
+#include <boost/test/included/unit_test.hpp>
+
+using namespace Storage_B::Weather;
+
+//
+// Every heap allocation of the program goes through here
+//
+static std::atomic<bool> counting(false);
+static std::atomic<size_t> allocations(0);
+
+void *operator new(size_t size)
+{
+  if (counting) allocations++;
+
+  void *p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+  free(p);
+}
+
+static const char *REPORTS[] =
+{
+  "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029 RMK AO2 SLP260 T00940061",
+  "METAR LBBG 041600Z 12012MPS 090V150 1400 R04/P1500N R22/P1500U +SN "
+  "BKN022 OVC050 M04/M07 Q1020 NOSIG 8849//91=",
+  "KHLN 041610Z 28009KT 1/2SM SN FZFG VV007 M10/M12 A2998 RMK AO2 T11001117",
+  "EDDH 161150Z 24015G27KT 9999 VCBLSN FEW012 SCT025 BKN040 TEMPO SHSN "
+  "+TSRA FEW001 FEW002 FEW003 01/M02 Q1003",
+  "???"
+};
+
+BOOST_AUTO_TEST_CASE(parser_matches_create)
+{
+  auto parser = MetarParser::Create();
+
+  for (auto report : REPORTS)
+  {
+    auto metar = Metar::Create(report);
+    bool decoded = parser->Parse(report, strlen(report));
+    const Metar& current = parser->Report();
+
+    BOOST_TEST(decoded == metar->hasICAO());
+    BOOST_TEST(current.hasICAO() == metar->hasICAO());
+    BOOST_TEST(current.WindSpeed() == metar->WindSpeed());
+    BOOST_TEST(current.Temperature() == metar->Temperature());
+    BOOST_TEST(current.SeaLevelPressure() == metar->SeaLevelPressure());
+
+    BOOST_TEST(current.NumCloudLayers() == metar->NumCloudLayers());
+    for (unsigned int i = 0 ; i < metar->NumCloudLayers() ; i++)
+    {
+      BOOST_TEST(current.Layer(i)->Altitude() == metar->Layer(i)->Altitude());
+    }
+
+    BOOST_TEST(current.NumPhenomena() == metar->NumPhenomena());
+    for (unsigned int i = 0 ; i < metar->NumPhenomena() ; i++)
+    {
+      BOOST_TEST(current.Phenomenon(i).NumPhenom() ==
+                 metar->Phenomenon(i).NumPhenom());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parser_reset)
+{
+  auto parser = MetarParser::Create();
+
+  BOOST_TEST(parser->Parse(REPORTS[0], strlen(REPORTS[0])));
+  BOOST_TEST(parser->Report().NumCloudLayers() == 1U);
+
+  parser->Reset();
+  BOOST_TEST(!parser->Report().hasICAO());
+  BOOST_TEST(!parser->Report().hasWindSpeed());
+  BOOST_TEST(parser->Report().NumCloudLayers() == 0U);
+  BOOST_TEST(parser->Report().NumPhenomena() == 0U);
+}
+
+BOOST_AUTO_TEST_CASE(parser_layer_outlives_parser)
+{
+  std::shared_ptr<Clouds> layer;
+  {
+    auto parser = MetarParser::Create();
+    parser->Parse(REPORTS[0], strlen(REPORTS[0]));
+    layer = parser->Report().Layer(0);
+  }
+
+  BOOST_TEST(layer->Altitude() == 15);
+}
+
+BOOST_AUTO_TEST_CASE(parser_layer_outlives_parse)
+{
+  auto parser = MetarParser::Create();
+  parser->Parse(REPORTS[0], strlen(REPORTS[0]));
+  auto layer = parser->Report().Layer(0);
+
+  const char *next = "KSTL 231751Z 27009KT 10SM BKN250 09/06 A3029";
+  parser->Parse(next, strlen(next));
+  BOOST_TEST(parser->Report().Layer(0)->Altitude() == 250);
+  BOOST_TEST(layer->Altitude() == 15);
+
+  parser->Reset();
+  BOOST_TEST(layer->Altitude() == 15);
+}
+
+BOOST_AUTO_TEST_CASE(parser_steady_state_allocations)
+{
+  auto parser = MetarParser::Create();
+
+  // warm up
+  for (auto report : REPORTS)
+  {
+    parser->Parse(report, strlen(report));
+  }
+
+  size_t layers = 0;
+
+  allocations = 0;
+  counting = true;
+  for (int i = 0 ; i < 1000 ; i++)
+  {
+    for (auto report : REPORTS)
+    {
+      parser->Parse(report, strlen(report), Metar::parse_mode::GRAMMAR);
+      const Metar& metar = parser->Report();
+      for (unsigned int l = 0 ; l < metar.NumCloudLayers() ; l++)
+      {
+        layers += metar.CloudLayers()[l].Altitude() >= 0;
+      }
+    }
+    parser->Reset();
+  }
+  counting = false;
+
+  BOOST_TEST(allocations == 0U);
+  BOOST_TEST(layers > 0U);
+}
@@ -396,3 +396,165 @@ BOOST_AUTO_TEST_CASE(phenom_vicinity_blowing)
     BOOST_CHECK(p.Vicinity() == true);
     BOOST_CHECK(p.Blowing() == true);
 }
+
+BOOST_AUTO_TEST_CASE(phenom_length_bounded)
+{
+  const char *str = "-SHRA BR";
+
+  auto result = Phenom::Create(str, size_t(3));
+
+  BOOST_CHECK(result->NumPhenom() == 1);
+  BOOST_CHECK((*result)[0] == Phenom::phenom::SHOWER);
+  BOOST_CHECK(result->Intensity() == Phenom::intensity::LIGHT);
+
+  BOOST_CHECK(Phenom::Create(str, size_t(2)) == nullptr);
+  BOOST_CHECK(Phenom::Create(str, size_t(0)) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(phenom_every_code)
+{
+  struct { const char *code; Phenom::phenom p; } codes[] =
+  {
+    { "BR", Phenom::phenom::MIST },
+    { "DS", Phenom::phenom::DUST_STORM },
+    { "DU", Phenom::phenom::DUST },
+    { "DZ", Phenom::phenom::DRIZZLE },
+    { "FC", Phenom::phenom::FUNNEL_CLOUD },
+    { "FG", Phenom::phenom::FOG },
+    { "FU", Phenom::phenom::SMOKE },
+    { "GR", Phenom::phenom::HAIL },
+    { "GS", Phenom::phenom::SMALL_HAIL },
+    { "HZ", Phenom::phenom::HAZE },
+    { "IC", Phenom::phenom::ICE_CRYSTALS },
+    { "PE", Phenom::phenom::ICE_PELLETS },
+    { "PL", Phenom::phenom::ICE_PELLETS },
+    { "PO", Phenom::phenom::DUST_SAND_WHORLS },
+    { "PY", Phenom::phenom::SPRAY },
+    { "RA", Phenom::phenom::RAIN },
+    { "SA", Phenom::phenom::SAND },
+    { "SG", Phenom::phenom::SNOW_GRAINS },
+    { "SH", Phenom::phenom::SHOWER },
+    { "SN", Phenom::phenom::SNOW },
+    { "SQ", Phenom::phenom::SQUALLS },
+    { "SS", Phenom::phenom::SAND_STORM },
+    { "UP", Phenom::phenom::UNKNOWN_PRECIP },
+    { "VA", Phenom::phenom::VOLCANIC_ASH }
+  };
+
+  for (const auto& c : codes)
+  {
+    auto result = Phenom::Create(c.code);
+    BOOST_REQUIRE(result);
+    BOOST_CHECK(result->NumPhenom() == 1);
+    BOOST_CHECK((*result)[0] == c.p);
+  }
+
+  auto result = Phenom::Create("VCBLDRFZPRMIBCTS");
+  BOOST_REQUIRE(result);
+  BOOST_CHECK(result->NumPhenom() == 0);
+  BOOST_CHECK(result->Vicinity() && result->Blowing() && result->Drifting());
+  BOOST_CHECK(result->Freezing() && result->Partial() && result->Shallow());
+  BOOST_CHECK(result->Patches() && result->ThunderStorm());
+
+  // unknown pairs and lower case are skipped
+  BOOST_CHECK(Phenom::Create("XXQQ") == nullptr);
+  BOOST_CHECK(Phenom::Create("ra") == nullptr);
+  BOOST_CHECK(Phenom::Create("XXRA")->NumPhenom() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(phenom_group_packed)
+{
+  BOOST_CHECK(sizeof(PhenomGroup) == 8);
+
+  PhenomGroup group;
+  BOOST_REQUIRE(Phenom::Decode("+FZRASN", 7, true, group));
+
+  BOOST_CHECK(group.phenoms == (PhenomGroup::Mask(Phenom::phenom::RAIN)
+                              | PhenomGroup::Mask(Phenom::phenom::SNOW)));
+  BOOST_CHECK(group.descriptors ==
+              (PhenomGroup::FREEZING | PhenomGroup::TEMPORARY));
+  BOOST_CHECK(group.Intensity() == Phenom::intensity::HEAVY);
+
+  // phenomena come back in report order
+  auto p = Phenom::Create(group);
+  BOOST_CHECK(p->NumPhenom() == 2);
+  BOOST_CHECK((*p)[0] == Phenom::phenom::RAIN);
+  BOOST_CHECK((*p)[1] == Phenom::phenom::SNOW);
+  BOOST_CHECK((*p)[2] == Phenom::phenom::NONE);
+  BOOST_CHECK(p->Freezing());
+  BOOST_CHECK(p->Temporary());
+  BOOST_CHECK(!p->ThunderStorm());
+}
+
+BOOST_AUTO_TEST_CASE(phenom_report_order)
+{
+  // report order differs from PhenomGroup::Mask() bit order, the first
+  // reported is predominant
+  auto p = Phenom::Create("-SNRA");
+  BOOST_CHECK(p->NumPhenom() == 2);
+  BOOST_CHECK((*p)[0] == Phenom::phenom::SNOW);
+  BOOST_CHECK((*p)[1] == Phenom::phenom::RAIN);
+
+  p = Phenom::Create("DZRA");
+  BOOST_CHECK((*p)[0] == Phenom::phenom::DRIZZLE);
+  BOOST_CHECK((*p)[1] == Phenom::phenom::RAIN);
+
+  p = Phenom::Create("RADZ");
+  BOOST_CHECK((*p)[0] == Phenom::phenom::RAIN);
+  BOOST_CHECK((*p)[1] == Phenom::phenom::DRIZZLE);
+
+  p = Phenom::Create("SHSNRA");
+  BOOST_CHECK((*p)[0] == Phenom::phenom::SHOWER);
+  BOOST_CHECK((*p)[1] == Phenom::phenom::SNOW);
+  BOOST_CHECK((*p)[2] == Phenom::phenom::RAIN);
+
+  // a repeat keeps the first position
+  p = Phenom::Create("SNRASN");
+  BOOST_CHECK(p->NumPhenom() == 2);
+  BOOST_CHECK((*p)[0] == Phenom::phenom::SNOW);
+  BOOST_CHECK((*p)[1] == Phenom::phenom::RAIN);
+
+  // beyond PhenomGroup::ORDERED the rest follow in bit order
+  p = Phenom::Create("UPSNRAGSDZ");
+  BOOST_CHECK(p->NumPhenom() == 5);
+  BOOST_CHECK((*p)[0] == Phenom::phenom::UNKNOWN_PRECIP);
+  BOOST_CHECK((*p)[1] == Phenom::phenom::SNOW);
+  BOOST_CHECK((*p)[2] == Phenom::phenom::RAIN);
+  BOOST_CHECK((*p)[3] == Phenom::phenom::SMALL_HAIL);
+  BOOST_CHECK((*p)[4] == Phenom::phenom::DRIZZLE);
+  BOOST_CHECK((*p)[5] == Phenom::phenom::NONE);
+
+  p = Phenom::Create("UPSNRAGSDZBR");
+  BOOST_CHECK((*p)[4] == Phenom::phenom::MIST);
+  BOOST_CHECK((*p)[5] == Phenom::phenom::DRIZZLE);
+}
+
+BOOST_AUTO_TEST_CASE(phenom_column_query)
+{
+  const char *codes[] = { "-FZRA", "FZFG", "+TSRA", "BR", "VCTS", "FZDZ" };
+  const size_t n = sizeof(codes) / sizeof(codes[0]);
+
+  PhenomGroup groups[n];
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    BOOST_REQUIRE(Phenom::Decode(codes[i], strlen(codes[i]), false,
+                                 groups[i]));
+  }
+
+  bool match[n];
+
+  // freezing precipitation
+  BOOST_CHECK(Phenom::Match(groups, n, PhenomGroup::PRECIPITATION,
+                            PhenomGroup::FREEZING, match) == 2);
+  BOOST_CHECK(match[0] && !match[1] && match[5]);
+
+  // any thunderstorm
+  BOOST_CHECK(Phenom::Match(groups, n, 0, PhenomGroup::THUNDERSTORM) == 2);
+
+  // any mist or fog
+  BOOST_CHECK(Phenom::Match(groups, n,
+                            PhenomGroup::Mask(Phenom::phenom::MIST)
+                          | PhenomGroup::Mask(Phenom::phenom::FOG), 0,
+                            match) == 2);
+  BOOST_CHECK(match[1] && match[3]);
+}
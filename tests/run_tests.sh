@@ -1,3 +1,3 @@
 #!/bin/bash
 cd .. && make && cd -
-make && ./cloud_test && ./phenom_test && ./metar_test && ./conv_test && ./utils_test
+make && ./cloud_test && ./phenom_test && ./metar_test && ./conv_test && ./utils_test && ./parallel_test && ./archive_test && ./charclass_test && ./arena_test && ./units_test && ./event_test && ./parser_test && ./stream_test
@@ -0,0 +1,228 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Push decoder tests
+//
+
+#include "MetarStream.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE METAR
+#include <boost/test/included/unit_test.hpp>
+
+using namespace std;
+using namespace Storage_B::Weather;
+
+//
+// A NOAA station file: observation time, then the report
+//
+static const char *INPUT =
+    "2018/11/05 15:20\r\n"
+    "METAR KSTL 051520Z 12017G25KT 090V150 1 1/2SM -TSRA BR FEW008 "
+    "OVC015CB M06/M08 A2989 RMK AO2 SLP132 T10561078\r\n"
+    "\n"
+    "KHLN 041610Z 28009KT 1/2SM SN FZFG VV007 M10/M12 A2998";
+
+struct Line
+{
+  string text;
+  MetarRecord rec;
+  bool ok;
+};
+
+struct Collect
+{
+  vector<Line> lines;
+
+  void operator()(const char *line, size_t len, const MetarRecord& rec,
+                  bool ok)
+  {
+    BOOST_TEST(strlen(line) == len);
+    lines.push_back({ string(line, len), rec, ok });
+  }
+};
+
+static void check(const vector<Line>& lines)
+{
+  BOOST_TEST(lines.size() == 3U);
+
+  BOOST_TEST(lines[0].text == "2018/11/05 15:20");
+
+  BOOST_TEST(lines[1].ok);
+  BOOST_TEST(lines[1].text.back() == '8');
+  BOOST_TEST(lines[1].rec.icao == "KSTL");
+  BOOST_TEST(lines[1].rec.wind_spd == 17);
+  BOOST_TEST(lines[1].rec.gust == 25);
+  BOOST_TEST(lines[1].rec.altimeterA == 2989);
+  BOOST_TEST(lines[1].rec.slp == 10132);
+
+  BOOST_TEST(lines[2].ok);
+  BOOST_TEST(lines[2].rec.icao == "KHLN");
+  BOOST_TEST(lines[2].rec.temp == -10);
+}
+
+BOOST_AUTO_TEST_CASE(stream_whole)
+{
+  char buffer[256];
+  MetarStream stream(buffer, sizeof(buffer));
+  Collect collect;
+
+  BOOST_TEST(stream.Push(INPUT, strlen(INPUT), collect) == 2U);
+  BOOST_TEST(stream.Pending() > 0U);
+  BOOST_TEST(stream.Finish(collect) == 1U);
+  BOOST_TEST(stream.Pending() == 0U);
+  BOOST_TEST(stream.Finish(collect) == 0U);
+
+  check(collect.lines);
+}
+
+BOOST_AUTO_TEST_CASE(stream_every_split)
+{
+  const size_t len = strlen(INPUT);
+
+  for (size_t chunk = 1 ; chunk <= 7 ; chunk++)
+  {
+    char buffer[256];
+    MetarStream stream(buffer, sizeof(buffer));
+    Collect collect;
+
+    for (size_t i = 0 ; i < len ; i += chunk)
+    {
+      stream.Push(INPUT + i, min(chunk, len - i), collect);
+    }
+    stream.Finish(collect);
+
+    check(collect.lines);
+  }
+
+  for (size_t split = 0 ; split <= len ; split++)
+  {
+    char buffer[256];
+    MetarStream stream(buffer, sizeof(buffer));
+    Collect collect;
+
+    stream.Push(INPUT, split, collect);
+    stream.Push(INPUT + split, len - split, collect);
+    stream.Finish(collect);
+
+    check(collect.lines);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(stream_matches_decode)
+{
+  const char *report = "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029";
+
+  MetarRecord rec;
+  BOOST_TEST(Metar::Decode(report, strlen(report), rec));
+
+  char buffer[64];
+  MetarStream stream(buffer, sizeof(buffer));
+  size_t calls = 0;
+
+  stream.Push(report, strlen(report),
+              [&](const char *, size_t, const MetarRecord& r, bool ok)
+              {
+                BOOST_TEST(ok);
+                BOOST_TEST(r.wind_spd == rec.wind_spd);
+                BOOST_TEST(r.temp == rec.temp);
+                BOOST_TEST(r.altimeterA == rec.altimeterA);
+                calls++;
+              });
+  BOOST_TEST(calls == 0U);
+  stream.Push("\n", 1,
+              [&](const char *, size_t, const MetarRecord&, bool)
+              {
+                calls++;
+              });
+  BOOST_TEST(calls == 1U);
+}
+
+BOOST_AUTO_TEST_CASE(stream_caller_record)
+{
+  char buffer[256];
+  MetarStream stream(buffer, sizeof(buffer));
+  Collect collect;
+
+  // every line is decoded into, and handed back as, the caller's record
+  MetarRecord rec;
+  size_t calls = 0;
+  auto same = [&](const char *line, size_t len, const MetarRecord& r,
+                  bool ok)
+  {
+    BOOST_TEST(&r == &rec);
+    collect(line, len, r, ok);
+    calls++;
+  };
+
+  BOOST_TEST(stream.Push(INPUT, strlen(INPUT), rec, same) == 2U);
+  BOOST_TEST(stream.Finish(rec, same) == 1U);
+  BOOST_TEST(calls == 3U);
+
+  check(collect.lines);
+  BOOST_TEST(rec.temp == collect.lines.back().rec.temp);
+}
+
+BOOST_AUTO_TEST_CASE(stream_long_line)
+{
+  const char *report =
+      "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029 RMK AO2 SLP260\n"
+      "KHLN 041610Z 28009KT\n";
+
+  // room for "KSTL 231751Z 27009KT 10S", cut back to the wind group
+  char buffer[25];
+  MetarStream stream(buffer, sizeof(buffer));
+  Collect collect;
+
+  BOOST_TEST(stream.Push(report, strlen(report), collect) == 2U);
+
+  BOOST_TEST(collect.lines.size() == 2U);
+  BOOST_TEST(collect.lines[0].text == "KSTL 231751Z 27009KT");
+  BOOST_TEST(collect.lines[0].rec.wind_spd == 9);
+  BOOST_TEST(!collect.lines[0].rec.hasVisibility());
+  BOOST_TEST(!collect.lines[0].rec.hasAltimeterA());
+  BOOST_TEST(collect.lines[1].text == "KHLN 041610Z 28009KT");
+}
+
+BOOST_AUTO_TEST_CASE(stream_long_line_group_boundary)
+{
+  const char *report = "KSTL 231751Z 27009KT 10SM OVC015 09/06 A3029\n";
+
+  // room for exactly "KSTL 231751Z 27009KT", the wind group is whole
+  char buffer[21];
+  MetarStream stream(buffer, sizeof(buffer));
+  Collect collect;
+
+  BOOST_TEST(stream.Push(report, strlen(report), collect) == 1U);
+
+  // and with the cut falling between two pushes
+  for (size_t i = 0 ; report[i] ; i++)
+  {
+    stream.Push(report + i, 1, collect);
+  }
+
+  BOOST_TEST(collect.lines.size() == 2U);
+  for (const auto& line : collect.lines)
+  {
+    BOOST_TEST(line.text == "KSTL 231751Z 27009KT");
+    BOOST_TEST(line.rec.wind_spd == 9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(stream_reset)
+{
+  char buffer[64];
+  MetarStream stream(buffer, sizeof(buffer));
+  Collect collect;
+
+  stream.Push("KSTL 2317", 9, collect);
+  stream.Reset();
+  BOOST_TEST(stream.Pending() == 0U);
+
+  stream.Push("KHLN 041610Z 28009KT\n", 21, collect);
+  BOOST_TEST(collect.lines.size() == 1U);
+  BOOST_TEST(collect.lines[0].rec.icao == "KHLN");
+}
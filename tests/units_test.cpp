@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2018 James A. Chappell
+//
+// Unit typed quantity tests
+//
+
+#include "Units.h"
+#include "Convert.h"
+
+#include <cmath>
+#include <vector>
+
+#define BOOST_TEST_MODULE METAR
+#include <boost/test/included/unit_test.hpp>
+
+using namespace Storage_B::Weather;
+
+// resolved at compile time
+static_assert(Speed<KilometersPerHour>(Speed<Knots>(10.0)).Value() == 18.52,
+              "knots to km/h");
+static_assert(Temperature<Fahrenheit>(Temperature<Celsius>(100.0)).Value()
+              == 212.0, "Celsius to Fahrenheit");
+static_assert(sizeof(Speed<Knots>) == sizeof(double), "no overhead");
+
+BOOST_AUTO_TEST_CASE(units_match_convert)
+{
+  BOOST_TEST(Speed<Knots>(12.0).As<KilometersPerHour>().Value() ==
+             Convert::Kts2Kph(12.0));
+  BOOST_TEST(Speed<Knots>(12.0).As<MilesPerHour>().Value() ==
+             Convert::Kts2Mph(12.0));
+  BOOST_TEST(Speed<Knots>(12.0).As<MetersPerSecond>().Value() ==
+             Convert::Kts2Mps(12.0));
+  BOOST_TEST(Distance<Meters>(100.0).As<Feet>().Value() ==
+             Convert::m2f(100.0));
+  BOOST_TEST(Pressure<HectoPascal>(1013.0).As<InchesOfMercury>().Value() ==
+             Convert::mb2InMg(1013.0));
+  BOOST_TEST(Temperature<Celsius>(-40.0).As<Fahrenheit>().Value() ==
+             Convert::c2f(-40.0));
+}
+
+BOOST_AUTO_TEST_CASE(units_round_trip, * boost::unit_test::tolerance(1e-12))
+{
+  Speed<MetersPerSecond> mps(Speed<Knots>(20.0));
+  BOOST_TEST(mps.As<Knots>().Value() == 20.0);
+
+  Distance<StatuteMiles> sm(Distance<Kilometers>(16.0934));
+  BOOST_TEST(sm.Value() == 10.0);
+  BOOST_TEST(sm.As<NauticalMiles>().Value() == 16093.4 / 1852.0);
+
+  Temperature<Celsius> c(Temperature<Fahrenheit>(50.0));
+  BOOST_TEST(c.Value() == 10.0);
+}
+
+BOOST_AUTO_TEST_CASE(units_arithmetic)
+{
+  Speed<Knots> a(10.0);
+  Speed<Knots> b(Speed<KilometersPerHour>(18.52));
+
+  BOOST_TEST(std::fabs((a - b).Value()) < 1e-12);
+  BOOST_CHECK((a + a) == a * 2.0);
+  BOOST_CHECK(a / 2.0 < a);
+  BOOST_CHECK(Speed<Knots>(5.0) + Speed<MilesPerHour>(0.0) == a / 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(units_reported)
+{
+  BOOST_TEST(Units::ToSpeed<KilometersPerHour>(10.0,
+                 Metar::speed_units::KT).Value() == 18.52);
+  BOOST_TEST(Units::ToSpeed<KilometersPerHour>(10.0,
+                 Metar::speed_units::MPS).Value() ==
+             10.0 * (1.852 / 0.514444));
+  BOOST_TEST(Units::ToSpeed<KilometersPerHour>(10.0,
+                 Metar::speed_units::KPH).Value() == 10.0);
+  BOOST_TEST(Units::ToDistance<Meters>(9999.0,
+                 Metar::distance_units::M).Value() == 9999.0);
+  BOOST_TEST(Units::ToDistance<Kilometers>(10.0,
+                 Metar::distance_units::SM).Value() ==
+             10.0 * (0.001 / (1.0 / 1609.34)));
+}
+
+BOOST_AUTO_TEST_CASE(units_batch)
+{
+  std::vector<double> in = { 0.0, 5.0, 10.0, 15.0, 20.0, 25.0, 30.0 };
+  std::vector<double> out(in.size());
+
+  Units::Convert<Knots, KilometersPerHour>(in.data(), out.data(), in.size());
+  for (size_t i = 0 ; i < in.size() ; i++)
+  {
+    BOOST_TEST(out[i] == Convert::Kts2Kph(in[i]));
+  }
+
+  Units::Convert<Celsius, Fahrenheit>(in.data(), out.data(), in.size());
+  for (size_t i = 0 ; i < in.size() ; i++)
+  {
+    BOOST_TEST(out[i] == Convert::c2f(in[i]));
+  }
+
+  Units::Normalize<KilometersPerHour>(in.data(), Metar::speed_units::KT,
+                                      out.data(), in.size());
+  for (size_t i = 0 ; i < in.size() ; i++)
+  {
+    BOOST_TEST(out[i] == Convert::Kts2Kph(in[i]));
+  }
+
+  std::vector<Speed<Knots>> knots(in.size());
+  std::vector<Speed<MilesPerHour>> mph(in.size());
+  for (size_t i = 0 ; i < in.size() ; i++)
+  {
+    knots[i] = Speed<Knots>(in[i]);
+  }
+  Units::Convert(knots.data(), mph.data(), knots.size());
+  for (size_t i = 0 ; i < in.size() ; i++)
+  {
+    BOOST_TEST(mph[i].Value() == Convert::Kts2Mph(in[i]));
+  }
+}
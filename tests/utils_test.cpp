@@ -6,6 +6,10 @@
 
 #include "Utils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #define BOOST_TEST_MODULE METAR
 #include <boost/test/included/unit_test.hpp>
 
@@ -51,3 +55,108 @@ BOOST_AUTO_TEST_CASE(heat_index, * boost::unit_test::tolerance(0.05))
   
   BOOST_TEST(Utils::HeatIndex(30.0, 75.0, true) == 36.0);
 }
+
+//
+// Batch versions against the scalar ones over the documented ranges,
+// with a length that leaves a partial vector at the end
+//
+BOOST_AUTO_TEST_CASE(batch_matches_scalar)
+{
+  std::vector<double> t, td, wind, rh;
+  for (int i = 0 ; i <= 120 ; i++)
+  {
+    for (int j = 0 ; j <= 40 ; j++)
+    {
+      t.push_back(-60.0 + i);
+      td.push_back(-60.0 + i - j * 0.75);
+      wind.push_back(j * 5.0 + 0.3);
+      rh.push_back(j * 2.5);
+    }
+  }
+  t.push_back(20.0);
+  td.push_back(20.0);
+  wind.push_back(4.8);
+  rh.push_back(100.0);
+
+  size_t n = t.size();
+  std::vector<double> out(n);
+
+  Utils::Humidity(t.data(), td.data(), out.data(), n);
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    BOOST_TEST(std::fabs(out[i] - Utils::Humidity(t[i], td[i])) < 1e-12);
+  }
+  BOOST_TEST(out[n - 1] == 100.0);
+
+  Utils::WindChill(t.data(), wind.data(), out.data(), n);
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    BOOST_TEST(std::fabs(out[i] - Utils::WindChill(t[i], wind[i])) < 1e-12);
+  }
+
+  std::vector<double> f(n);
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    f[i] = 60.0 + (t[i] + 60.0) * 0.5;
+  }
+
+  Utils::HeatIndex(f.data(), rh.data(), out.data(), n);
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    BOOST_TEST(std::fabs(out[i] - Utils::HeatIndex(f[i], rh[i])) < 1e-12);
+  }
+
+  Utils::HeatIndex(t.data(), rh.data(), out.data(), n, true);
+  for (size_t i = 0 ; i < n ; i++)
+  {
+    BOOST_TEST(std::fabs(out[i] - Utils::HeatIndex(t[i], rh[i], true))
+               < 1e-12);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batch_in_place)
+{
+  double t[] = { 5.0, 10.0, 0.0 };
+  double wind[] = { 13.0, 20.0, 50.0 };
+
+  Utils::WindChill(t, wind, t, 3);
+
+  BOOST_TEST(std::fabs(t[0] - 2.1) < 0.05);
+  BOOST_TEST(std::fabs(t[1] - 7.4) < 0.05);
+  BOOST_TEST(std::fabs(t[2] + 8.1) < 0.05);
+}
+
+//
+// Fast approximations against the exact versions over the documented
+// domain
+//
+BOOST_AUTO_TEST_CASE(fast_humidity)
+{
+  double worst = 0.0;
+  for (double t = -60.0 ; t <= 60.0 ; t += 0.25)
+  {
+    for (double td = -80.0 ; td <= t ; td += 0.25)
+    {
+      worst = std::max(worst, std::fabs(Utils::HumidityFast(t, td)
+                                        - Utils::Humidity(t, td)));
+    }
+  }
+
+  BOOST_TEST(worst < 0.01);
+}
+
+BOOST_AUTO_TEST_CASE(fast_wind_chill)
+{
+  double worst = 0.0;
+  for (double t = -60.0 ; t <= 60.0 ; t += 0.25)
+  {
+    for (double v = 0.0 ; v <= 300.0 ; v += 0.25)
+    {
+      worst = std::max(worst, std::fabs(Utils::WindChillFast(t, v)
+                                        - Utils::WindChill(t, v)));
+    }
+  }
+
+  BOOST_TEST(worst < 0.02);
+  BOOST_TEST(Utils::WindChillFast(5.0, 4.8) == 5.0);
+}